@@ -9,12 +9,42 @@ AUTO_LOAD = ["sensor", "text_sensor", "binary_sensor", "switch"]
 MULTI_CONF = True
 
 CONF_TOSHIBA_LOG_ID = "toshiba_log_id"
+CONF_FRAME_DUMP = "frame_dump"
+CONF_FRAME_DUMP_SAMPLE = "frame_dump_sample"
+CONF_CAPTURE = "capture"
+CONF_CAPTURE_PARTITION = "capture_partition"
+CONF_CAPTURE_COMPRESS = "capture_compress"
 
 toshiba_log_ns = cg.esphome_ns.namespace("toshiba_log")
 ToshibaLog = toshiba_log_ns.class_("ToshibaLog", cg.Component, uart.UARTDevice)
 
+# raw hex dump of sniffed frames on Serial; "errors" only dumps frames the
+# fixer could not repair, "sampled" every frame_dump_sample-th frame
+FrameDump = toshiba_log_ns.enum("FrameDump")
+FRAME_DUMP_MODES = {
+    "off": FrameDump.FRAME_DUMP_OFF,
+    "errors": FrameDump.FRAME_DUMP_ERRORS,
+    "sampled": FrameDump.FRAME_DUMP_SAMPLED,
+    "all": FrameDump.FRAME_DUMP_ALL,
+}
+
+# timestamped binary capture of every sniffed and sent frame; "flash" drains
+# the RAM ring to the data partition named by capture_partition (ESP32),
+# protocol-aware compressed unless capture_compress is false
+CaptureMode = toshiba_log_ns.enum("CaptureMode")
+CAPTURE_MODES = {
+    "off": CaptureMode.CAPTURE_OFF,
+    "ram": CaptureMode.CAPTURE_RAM,
+    "flash": CaptureMode.CAPTURE_FLASH,
+}
+
 CONFIG_SCHEMA = cv.Schema({
     cv.GenerateID(): cv.declare_id(ToshibaLog),
+    cv.Optional(CONF_FRAME_DUMP, default="all"): cv.enum(FRAME_DUMP_MODES, lower=True),
+    cv.Optional(CONF_FRAME_DUMP_SAMPLE, default=10): cv.int_range(min=1, max=65535),
+    cv.Optional(CONF_CAPTURE, default="off"): cv.enum(CAPTURE_MODES, lower=True),
+    cv.Optional(CONF_CAPTURE_PARTITION, default="capture"): cv.string_strict,
+    cv.Optional(CONF_CAPTURE_COMPRESS, default=True): cv.boolean,
 }).extend(cv.COMPONENT_SCHEMA).extend(uart.UART_DEVICE_SCHEMA)
 
 # this component's frame sync detection (0xA0 0x00) only matches the
@@ -32,4 +62,6 @@ FINAL_VALIDATE_SCHEMA = uart.final_validate_device_schema(
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
-    await uart.register_uart_device(var, config)
\ No newline at end of file
+    await uart.register_uart_device(var, config)
+    cg.add(var.set_frame_dump(config[CONF_FRAME_DUMP], config[CONF_FRAME_DUMP_SAMPLE]))
+    cg.add(var.set_capture(config[CONF_CAPTURE], config[CONF_CAPTURE_PARTITION], config[CONF_CAPTURE_COMPRESS]))
@@ -0,0 +1,205 @@
+/*
+binary-log.cpp - Estia R32 heat pump deferred binary diagnostics log
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "binary-log.hpp"
+#include <stdio.h>
+#include <string.h>
+
+PackedStatus PackedStatus::pack(const StatusData& data) {
+	const bool flags[] = {
+	    data.extendedData, data.cooling, data.heating, data.hotWater, data.autoMode,
+	    data.quietMode, data.nightMode, data.backupHeater, data.coolingCMP, data.heatingCMP,
+	    data.hotWaterHeater, data.hotWaterCMP, data.pump1, data.defrostInProgress, data.nightModeActive,
+	};
+	PackedStatus packed = {data.error, data.operationMode, 0,
+	                       {data.hotWaterTarget, data.zone1Target, data.zone2Target,
+	                        data.hotWaterTarget2, data.zone1Target2, data.zone2Target2}};
+	for (uint8_t bit = 0; bit < sizeof(flags); bit++) {
+		if (flags[bit]) { packed.flags |= 1 << bit; }
+	}
+	return packed;
+}
+
+StatusData PackedStatus::unpack() const {
+	StatusData data = {};
+	bool* flagFields[] = {
+	    &data.extendedData, &data.cooling, &data.heating, &data.hotWater, &data.autoMode,
+	    &data.quietMode, &data.nightMode, &data.backupHeater, &data.coolingCMP, &data.heatingCMP,
+	    &data.hotWaterHeater, &data.hotWaterCMP, &data.pump1, &data.defrostInProgress, &data.nightModeActive,
+	};
+	data.error = error;
+	data.operationMode = operationMode;
+	for (uint8_t bit = 0; bit < sizeof(flagFields) / sizeof(flagFields[0]); bit++) {
+		*flagFields[bit] = flags & (1 << bit);
+	}
+	data.hotWaterTarget = targets[0];
+	data.zone1Target = targets[1];
+	data.zone2Target = targets[2];
+	data.hotWaterTarget2 = targets[3];
+	data.zone1Target2 = targets[4];
+	data.zone2Target2 = targets[5];
+	return data;
+}
+
+size_t LogRecord::serialize(uint8_t* out, size_t outSize) const {
+	if (outSize < static_cast<size_t>(BINARY_LOG_HEADER_SIZE + length)) { return 0; }
+
+	for (uint8_t idx = 0; idx < 4; idx++) {
+		out[idx] = timestamp >> (8 * idx);
+	}
+	out[4] = event;
+	out[5] = length;
+	memcpy(out + BINARY_LOG_HEADER_SIZE, payload, length);
+	return BINARY_LOG_HEADER_SIZE + length;
+}
+
+size_t LogRecord::deserialize(const uint8_t* data, size_t len, LogRecord& record) {
+	if (len < BINARY_LOG_HEADER_SIZE) { return 0; }
+	if (data[5] > BINARY_LOG_PAYLOAD_SIZE || len < static_cast<size_t>(BINARY_LOG_HEADER_SIZE + data[5])) { return 0; }
+
+	record.timestamp = 0;
+	for (uint8_t idx = 0; idx < 4; idx++) {
+		record.timestamp |= static_cast<uint32_t>(data[idx]) << (8 * idx);
+	}
+	record.event = data[4];
+	record.length = data[5];
+	memcpy(record.payload, data + BINARY_LOG_HEADER_SIZE, record.length);
+	return BINARY_LOG_HEADER_SIZE + record.length;
+}
+
+size_t LogRecord::format(char* out, size_t outSize) const {
+	if (outSize == 0) { return 0; }
+
+	int len = 0;
+	switch (event) {
+	case log_status: {
+		PackedStatus packed;
+		memcpy(&packed, payload, sizeof(packed));
+		StatusData data = packed.unpack();
+		len = snprintf(out, outSize,
+		               "%u status error=%u mode=%s cooling=%u heating=%u hotWater=%u auto=%u quiet=%u night=%u"
+		               " backupHeater=%u coolingCMP=%u heatingCMP=%u hotWaterHeater=%u hotWaterCMP=%u pump1=%u"
+		               " hotWaterTarget=%u zone1Target=%u zone2Target=%u",
+		               timestamp, data.error, data.operationMode == 0x06 ? "heating" : "cooling", data.cooling,
+		               data.heating, data.hotWater, data.autoMode, data.quietMode, data.nightMode, data.backupHeater,
+		               data.coolingCMP, data.heatingCMP, data.hotWaterHeater, data.hotWaterCMP, data.pump1,
+		               data.hotWaterTarget, data.zone1Target, data.zone2Target);
+		if (data.extendedData && len > 0 && static_cast<size_t>(len) < outSize) {
+			len += snprintf(out + len, outSize - len, " hotWaterTarget2=%u zone1Target2=%u zone2Target2=%u",
+			                data.hotWaterTarget2, data.zone1Target2, data.zone2Target2);
+		}
+		if (len > 0 && static_cast<size_t>(len) < outSize) {
+			len += snprintf(out + len, outSize - len, " defrost=%u nightActive=%u extended=%u",
+			                data.defrostInProgress, data.nightModeActive, data.extendedData);
+		}
+		break;
+	}
+	case log_frame:
+		len = snprintf(out, outSize, "%u frame ", timestamp);
+		if (len > 0 && static_cast<size_t>(len) < outSize) {
+			len += EstiaFrame::toHex(payload, length, out + len, outSize - len);
+		}
+		break;
+	case log_ack:
+		len = snprintf(out, outSize, "%u ack 0x%04x", timestamp, (payload[0] << 8) | payload[1]);
+		break;
+	default:
+		len = snprintf(out, outSize, "%u event %u, %u bytes", timestamp, event, length);
+		break;
+	}
+	if (len < 0) { len = 0; }
+	return static_cast<size_t>(len) < outSize ? len : outSize - 1;
+}
+
+BinaryLog::BinaryLog()
+    : records()
+    , head(0)
+    , tail(0)
+    , dropped(0) {
+}
+
+// free record for the producer, the oldest one when the consumer is behind
+LogRecord* BinaryLog::reserve() {
+	uint16_t current = head.load(std::memory_order_relaxed);
+	uint16_t oldest = tail.load(std::memory_order_acquire);
+	if (static_cast<uint16_t>(current - oldest) >= BINARY_LOG_RECORDS) {
+		// fails only if the consumer just popped it, which frees the record as well
+		if (tail.compare_exchange_strong(oldest, oldest + 1, std::memory_order_acq_rel)) { dropped++; }
+	}
+	return &records[current & (BINARY_LOG_RECORDS - 1)];
+}
+
+void BinaryLog::commit() {
+	head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void BinaryLog::logStatus(uint32_t timestamp, const StatusData& data) {
+	LogRecord* record = reserve();
+	PackedStatus packed = PackedStatus::pack(data);
+	record->timestamp = timestamp;
+	record->event = log_status;
+	record->length = sizeof(packed);
+	memcpy(record->payload, &packed, sizeof(packed));
+	commit();
+}
+
+void BinaryLog::logFrame(uint32_t timestamp, const uint8_t* data, uint8_t len) {
+	LogRecord* record = reserve();
+	record->timestamp = timestamp;
+	record->event = log_frame;
+	record->length = len < BINARY_LOG_PAYLOAD_SIZE ? len : BINARY_LOG_PAYLOAD_SIZE;
+	memcpy(record->payload, data, record->length);
+	commit();
+}
+
+void BinaryLog::logAck(uint32_t timestamp, uint16_t dataType) {
+	LogRecord* record = reserve();
+	record->timestamp = timestamp;
+	record->event = log_ack;
+	record->length = 2;
+	record->payload[0] = dataType >> 8;
+	record->payload[1] = dataType;
+	commit();
+}
+
+bool BinaryLog::pop(LogRecord& record) {
+	uint16_t current = tail.load(std::memory_order_acquire);
+	do {
+		if (current == head.load(std::memory_order_acquire)) { return false; }
+
+		const LogRecord& stored = records[current & (BINARY_LOG_RECORDS - 1)];
+		record.timestamp = stored.timestamp;
+		record.event = stored.event;
+		record.length = stored.length < BINARY_LOG_PAYLOAD_SIZE ? stored.length : BINARY_LOG_PAYLOAD_SIZE;
+		memcpy(record.payload, stored.payload, record.length);
+		// the producer dropped it meanwhile and may have overwritten it, `current` is reloaded
+	} while (!tail.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel));
+	return true;
+}
+
+size_t BinaryLog::size() const {
+	return static_cast<uint16_t>(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+}
+
+bool BinaryLog::empty() const {
+	return size() == 0;
+}
+
+uint32_t BinaryLog::droppedCount() const {
+	return dropped;
+}
@@ -0,0 +1,100 @@
+/*
+binary-log.hpp - Estia R32 heat pump deferred binary diagnostics log
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "frame.hpp"
+#include "status-frames.hpp"
+#include <atomic>
+
+#define BINARY_LOG_RECORDS 32                        // power of two
+#define BINARY_LOG_PAYLOAD_SIZE (FRAME_MAX_LEN + 2)    // a fixed frame may grow by 2
+#define BINARY_LOG_HEADER_SIZE 6
+#define BINARY_LOG_LINE_SIZE 320
+
+static_assert((BINARY_LOG_RECORDS & (BINARY_LOG_RECORDS - 1)) == 0, "binary log records must be a power of two");
+
+enum LogEvent : uint8_t {
+	log_status,    // payload: PackedStatus
+	log_frame,     // payload: raw frame bytes
+	log_ack,       // payload: acked data type, big endian
+	log_events,
+};
+
+// StatusData in 10 bytes, flags in `StatusData` declaration order
+struct PackedStatus {
+	uint8_t error;
+	uint8_t operationMode;
+	uint16_t flags;
+	uint8_t targets[6];    // hot water, zone1, zone2, then the extended ones
+
+	static PackedStatus pack(const StatusData& data);
+	StatusData unpack() const;
+};
+
+/**
+* Diagnostics record, timestamped when it is written, formatted when read.
+*
+* Serialized form (`serialize()`, also what host tools read), little
+* endian: u32 timestamp ms, u8 event (`LogEvent`), u8 payload length,
+* payload.
+*/
+struct LogRecord {
+	uint32_t timestamp;
+	uint8_t event;
+	uint8_t length;
+	uint8_t payload[BINARY_LOG_PAYLOAD_SIZE];
+
+	size_t serialize(uint8_t* out, size_t outSize) const;
+	static size_t deserialize(const uint8_t* data, size_t len, LogRecord& record);    // bytes used, 0 if incomplete
+	size_t format(char* out, size_t outSize) const;
+};
+
+/**
+* Lock-free single producer, single consumer ring of log records.
+*
+* The producer (the sniffer loop) only copies the record in, formatting is
+* left to whoever drains the ring: a log consumer on the device or a host
+* decoder reading serialized records. When the ring is full the oldest
+* record is dropped and counted, so the ring always holds the most recent
+* ones and the producer never waits for the consumer. A record dropped
+* while the consumer was copying it makes `pop()` move on to the next.
+*/
+class BinaryLog {
+  private:
+	LogRecord records[BINARY_LOG_RECORDS];
+	std::atomic<uint16_t> head;    // written by the producer
+	std::atomic<uint16_t> tail;    // advanced by the consumer, or by the producer dropping the oldest
+	uint32_t dropped;
+
+	LogRecord* reserve();
+	void commit();
+
+  public:
+	BinaryLog();
+	BinaryLog(const BinaryLog&) = delete;
+	BinaryLog& operator=(const BinaryLog&) = delete;
+
+	void logStatus(uint32_t timestamp, const StatusData& data);
+	void logFrame(uint32_t timestamp, const uint8_t* data, uint8_t len);
+	void logAck(uint32_t timestamp, uint16_t dataType);
+	bool pop(LogRecord& record);
+	size_t size() const;
+	bool empty() const;
+	uint32_t droppedCount() const;    // oldest records overwritten before they were read
+};
@@ -0,0 +1,194 @@
+/*
+bus-capture.cpp - Timestamped binary capture of Estia bus traffic
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "bus-capture.hpp"
+#include "capture-codec.hpp"
+#include <string.h>
+
+const char* CaptureRecord::outcomeName(uint8_t outcome) {
+	if (outcome == CAPTURE_FIX_CLEAN) { return "clean"; }
+	if (outcome == CAPTURE_FIX_FAILED) { return "failed"; }
+	if (outcome <= FrameFixer::fix_methods) { return FrameFixer::methodName(static_cast<FrameFixer::FixMethod>(outcome - 1)); }
+	return "";
+}
+
+size_t CaptureRecord::serialize(uint8_t* out, size_t outSize) const {
+	if (outSize < static_cast<size_t>(BUS_CAPTURE_HEADER_SIZE + length)) { return 0; }
+
+	for (uint8_t idx = 0; idx < 4; idx++) {
+		out[idx] = timestamp >> (8 * idx);
+	}
+	out[4] = flags;
+	out[5] = length;
+	memcpy(out + BUS_CAPTURE_HEADER_SIZE, data, length);
+	return BUS_CAPTURE_HEADER_SIZE + length;
+}
+
+size_t CaptureRecord::deserialize(const uint8_t* data, size_t len, size_t offset, CaptureRecord& record) {
+	size_t skipped = 0;
+	while (skipped < len) {
+		size_t remaining = BUS_CAPTURE_SECTOR_SIZE - (offset + skipped) % BUS_CAPTURE_SECTOR_SIZE;
+		if (remaining >= BUS_CAPTURE_HEADER_SIZE && len - skipped >= BUS_CAPTURE_HEADER_SIZE
+		    && data[skipped + 5] != BUS_CAPTURE_PADDING) {
+			break;
+		}
+		if (remaining >= BUS_CAPTURE_HEADER_SIZE && len - skipped < BUS_CAPTURE_HEADER_SIZE) { return 0; }
+		skipped += remaining;
+	}
+	if (skipped >= len) { return 0; }
+	data += skipped;
+	len -= skipped;
+	if (len < BUS_CAPTURE_HEADER_SIZE) { return 0; }
+	if (data[5] > FRAME_MAX_LEN || len < static_cast<size_t>(BUS_CAPTURE_HEADER_SIZE + data[5])) { return 0; }
+
+	record.timestamp = 0;
+	for (uint8_t idx = 0; idx < 4; idx++) {
+		record.timestamp |= static_cast<uint32_t>(data[idx]) << (8 * idx);
+	}
+	record.flags = data[4];
+	record.length = data[5];
+	memcpy(record.data, data + BUS_CAPTURE_HEADER_SIZE, record.length);
+	return skipped + BUS_CAPTURE_HEADER_SIZE + record.length;
+}
+
+// fill the rest of the current sector with padding
+bool CaptureSink::pad() {
+	uint8_t padding[16];
+	memset(padding, BUS_CAPTURE_PADDING, sizeof(padding));
+	for (size_t left = BUS_CAPTURE_SECTOR_SIZE - offset % BUS_CAPTURE_SECTOR_SIZE; left > 0;) {
+		size_t chunk = left < sizeof(padding) ? left : sizeof(padding);
+		if (!this->write(offset, padding, chunk)) { return false; }
+		offset += chunk;
+		left -= chunk;
+	}
+	return true;
+}
+
+bool CaptureSink::append(const uint8_t* record, size_t len) {
+	if (this->appendRecord(record, len)) { return true; }
+
+	// the codec already moved past the record, a retry starts over in a fresh sector
+	if (codec && offset % BUS_CAPTURE_SECTOR_SIZE != 0) { offset += BUS_CAPTURE_SECTOR_SIZE - offset % BUS_CAPTURE_SECTOR_SIZE; }
+	return false;
+}
+
+bool CaptureSink::appendRecord(const uint8_t* record, size_t len) {
+	CaptureRecord decoded;
+	uint8_t encoded[CAPTURE_CODEC_RECORD_MAX];
+	if (codec) {
+		CaptureRecord::deserialize(record, len, 0, decoded);
+		record = encoded;
+		len = codec->encode(decoded, encoded, sizeof(encoded));
+	}
+	bool fresh = offset % BUS_CAPTURE_SECTOR_SIZE == 0;
+	if (!fresh && offset % BUS_CAPTURE_SECTOR_SIZE + len > BUS_CAPTURE_SECTOR_SIZE) {
+		// the record goes to the next sector
+		if (!this->pad()) { return false; }
+		fresh = true;
+	}
+	if (fresh) {
+		if (!this->beginSector(offset)) { return false; }
+		if (codec) {
+			// every sector decodes on its own, the record is coded again from a reset state
+			uint8_t header[CAPTURE_CODEC_SECTOR_HEADER_SIZE];
+			CaptureCodec::sectorHeader(header);
+			if (!this->write(offset, header, sizeof(header))) { return false; }
+			offset += sizeof(header);
+			codec->reset();
+			len = codec->encode(decoded, encoded, sizeof(encoded));
+		}
+	}
+	if (!this->write(offset, record, len)) { return false; }
+
+	offset += len;
+	return true;
+}
+
+BusCapture::BusCapture()
+    : ring()
+    , lastLength(0)
+    , records(0)
+    , dropped(0)
+    , sink(nullptr) {
+}
+
+uint8_t BusCapture::outcome(bool crcValid, FrameFixer::FixMethod fix) {
+	if (fix != FrameFixer::fix_methods) { return fix + 1; }
+	return crcValid ? CAPTURE_FIX_CLEAN : CAPTURE_FIX_FAILED;
+}
+
+void BusCapture::discardOldest() {
+	this->consume(BUS_CAPTURE_HEADER_SIZE + ring.at(5));
+	dropped++;
+}
+
+void BusCapture::record(uint32_t timestamp, uint8_t flags, const uint8_t* data, uint8_t len) {
+	if (len > FRAME_MAX_LEN) { len = FRAME_MAX_LEN; }
+	while (ring.capacity() - ring.size() < static_cast<size_t>(BUS_CAPTURE_HEADER_SIZE + len)) {
+		discardOldest();
+	}
+
+	for (uint8_t idx = 0; idx < 4; idx++) {
+		ring.push_back(timestamp >> (8 * idx));
+	}
+	ring.push_back(flags);
+	ring.push_back(len);
+	for (uint8_t idx = 0; idx < len; idx++) {
+		ring.push_back(data[idx]);
+	}
+	lastLength = BUS_CAPTURE_HEADER_SIZE + len;
+	records++;
+}
+
+void BusCapture::amendLast(uint8_t flags) {
+	if (lastLength == 0) { return; }
+	ring.at(ring.size() - lastLength + 4) |= flags;
+}
+
+// copy the oldest record out of the ring, serialized
+size_t BusCapture::peek(uint8_t* out) const {
+	size_t len = BUS_CAPTURE_HEADER_SIZE + ring.at(5);
+	ring.copy(out, len);
+	return len;
+}
+
+void BusCapture::consume(size_t len) {
+	ring.discard(len);
+	if (ring.size() < lastLength) { lastLength = 0; }
+}
+
+bool BusCapture::pop(CaptureRecord& record) {
+	if (ring.empty()) { return false; }
+
+	uint8_t out[BUS_CAPTURE_RECORD_MAX];
+	size_t len = this->peek(out);
+	CaptureRecord::deserialize(out, len, 0, record);
+	this->consume(len);
+	return true;
+}
+
+bool BusCapture::drain() {
+	if (!sink || ring.empty()) { return false; }
+
+	uint8_t out[BUS_CAPTURE_RECORD_MAX];
+	size_t len = this->peek(out);
+	if (!sink->append(out, len)) { return false; }    // keep it for the next try
+
+	this->consume(len);
+	return true;
+}
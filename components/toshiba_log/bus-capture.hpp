@@ -0,0 +1,149 @@
+/*
+bus-capture.hpp - Timestamped binary capture of Estia bus traffic
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "frame-fixer.hpp"
+#include "frame.hpp"
+#include "ring-buffer.hpp"
+
+#define BUS_CAPTURE_SIZE 4096           // bytes of RAM ring, power of two
+#define BUS_CAPTURE_HEADER_SIZE 6
+#define BUS_CAPTURE_RECORD_MAX (BUS_CAPTURE_HEADER_SIZE + FRAME_MAX_LEN)
+#define BUS_CAPTURE_SECTOR_SIZE 4096    // flash erase unit, records never cross one
+#define BUS_CAPTURE_PADDING 0xff        // length byte of erased flash, skip to the next sector
+
+class CaptureCodec;
+
+#define CAPTURE_FIX_SHIFT 4
+#define CAPTURE_FIX_CLEAN 0x0     // CRC matched as received
+#define CAPTURE_FIX_FAILED 0xf    // FrameFixer gave up, 1 + `FixMethod` when it repaired the frame
+
+enum CaptureFlag : uint8_t {
+	capture_tx = 0x01,           // written by EstiaSerial::write(), else sniffed
+	capture_echo = 0x02,         // TX: self-echo suppression armed, RX: echo suppression broke off before this frame
+	capture_crc_valid = 0x04,    // RX: CRC matched after FrameFixer
+};
+
+/**
+* One captured frame.
+*
+* Stream format, little endian, records back to back:
+*
+*     u32 timestamp   EstiaClock::micros() when the frame was framed (RX) or sent (TX)
+*     u8  flags       `CaptureFlag` bits 0-3, fixer outcome in bits 4-7
+*     u8  length      raw byte count, at most FRAME_MAX_LEN
+*     u8  data[length]
+*
+* RX data is the frame exactly as framed, before FrameFixer touched it, so a
+* capture replayed into `FrameSync` takes the same path through the fixer as
+* it did on the bus.
+*
+* Streams written by a `CaptureSink` are cut into `BUS_CAPTURE_SECTOR_SIZE`
+* sectors, a record never crosses a sector boundary. The rest of a sector
+* is padded with `BUS_CAPTURE_PADDING` (erased flash), a reader skips to the
+* next boundary when fewer than a header's bytes are left or the length
+* byte is padding.
+*/
+struct CaptureRecord {
+	uint32_t timestamp;
+	uint8_t flags;
+	uint8_t length;
+	uint8_t data[FRAME_MAX_LEN];
+
+	bool tx() const { return flags & capture_tx; }
+	bool echo() const { return flags & capture_echo; }
+	bool crcValid() const { return flags & capture_crc_valid; }
+	uint8_t fixOutcome() const { return flags >> CAPTURE_FIX_SHIFT; }
+	static const char* outcomeName(uint8_t outcome);
+
+	size_t serialize(uint8_t* out, size_t outSize) const;
+	// bytes used from `data`, 0 if incomplete or invalid, padding is skipped
+	// relative to `offset`, the record's position in the stream
+	static size_t deserialize(const uint8_t* data, size_t len, size_t offset, CaptureRecord& record);
+};
+
+/**
+* Flash partition or file the RAM ring is drained to.
+*
+* `append()` lays records out in sectors, implementations only store bytes
+* at a stream offset and may prepare a sector before it is first written.
+* With a codec set, sectors start with the codec's sector header and hold
+* encoded records, see `capture-codec.hpp`.
+*/
+class CaptureSink {
+  private:
+	size_t offset;    // stream position, grows past the end of a wrapping store
+	CaptureCodec* codec;
+
+	bool pad();
+	bool appendRecord(const uint8_t* record, size_t len);
+
+  protected:
+	virtual bool write(size_t offset, const uint8_t* data, size_t len) = 0;
+	virtual bool beginSector(size_t /* offset */) { return true; }
+
+  public:
+	CaptureSink()
+	    : offset(0)
+	    , codec(nullptr) {}
+	virtual ~CaptureSink() = default;
+
+	bool append(const uint8_t* record, size_t len);    // a serialized record
+	void setCodec(CaptureCodec* codec) { this->codec = codec; }
+	size_t position() const { return offset; }
+};
+
+/**
+* Byte ring of serialized capture records, optionally drained to a sink.
+*
+* Records are variable length and packed, so the 4 KiB ring holds ~250
+* typical frames. Without a sink it keeps the most recent traffic, with one
+* the loop drains it a record at a time. Either way a full ring drops whole
+* old records and counts them. Producer and consumer run on the same loop,
+* there is no locking.
+*/
+class BusCapture {
+  private:
+	RingBuffer<uint8_t, BUS_CAPTURE_SIZE> ring;
+	uint8_t lastLength;    // bytes of the newest record, 0 once drained
+	uint32_t records;
+	uint32_t dropped;
+	CaptureSink* sink;
+
+	void discardOldest();
+	size_t peek(uint8_t* out) const;
+	void consume(size_t len);
+
+  public:
+	BusCapture();
+	BusCapture(const BusCapture&) = delete;
+	BusCapture& operator=(const BusCapture&) = delete;
+
+	void record(uint32_t timestamp, uint8_t flags, const uint8_t* data, uint8_t len);
+	void amendLast(uint8_t flags);    // OR flags into the newest record, e.g. the fixer outcome
+	bool pop(CaptureRecord& record);
+	bool drain();    // move the oldest record to the sink, false if nothing was written
+	void setSink(CaptureSink* sink) { this->sink = sink; }
+	size_t size() const { return ring.size(); }    // bytes
+	bool empty() const { return ring.empty(); }
+	uint32_t recordCount() const { return records; }
+	uint32_t droppedCount() const { return dropped; }
+
+	static uint8_t outcome(bool crcValid, FrameFixer::FixMethod fix);
+};
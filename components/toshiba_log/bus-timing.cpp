@@ -0,0 +1,90 @@
+/*
+bus-timing.cpp - Learned cadence of periodic master frames
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "bus-timing.hpp"
+#include <string.h>
+
+BusTiming::BusTiming()
+    : streams() {
+}
+
+void BusTiming::observe(FrameKind kind, uint32_t end, uint8_t length) {
+	if (kind == frame_unknown || kind >= BUS_TIMING_STREAMS) { return; }
+
+	BusStream& stream = streams[kind];
+	if (stream.seen) {
+		uint32_t interval = end - stream.lastEnd;
+		if (interval == 0) { return; }    // same frame seen twice in one pass
+		if (stream.samples == 0) {
+			stream.period = interval;
+			stream.jitter = 0;
+			stream.samples = 1;
+		} else {
+			uint32_t cycles = (interval + stream.period / 2) / stream.period;    // missed frames divided out
+			if (cycles > BUS_TIMING_MAX_MISSED) {
+				stream.samples = 0;    // gone for a while, learn it again
+			} else if (cycles == 0) {
+				// out of cadence, e.g. update after a command; the period may have
+				// shrunk below the jitter, which then stays as it is
+				if (stream.jitter < stream.period) { stream.jitter += (stream.period - stream.jitter) / 4; }
+			} else {
+				int32_t delta = static_cast<int32_t>(interval / cycles) - static_cast<int32_t>(stream.period);
+				uint32_t deviation = delta < 0 ? -delta : delta;
+				stream.period += delta / 8;
+				stream.jitter = stream.jitter + deviation / 4 - stream.jitter / 4;
+				if (stream.samples < UINT8_MAX) { stream.samples++; }
+			}
+		}
+	}
+	stream.lastEnd = end;
+	stream.length = length;
+	stream.seen = true;
+}
+
+bool BusTiming::predictable(const BusStream& stream, uint32_t now) const {
+	if (stream.samples < BUS_TIMING_MIN_SAMPLES || stream.period == 0) { return false; }
+	if (stream.jitter * 8 > stream.period || guard(stream) > BUS_TIMING_MAX_GUARD) { return false; }
+	return now - stream.lastEnd <= stream.period * BUS_TIMING_MAX_MISSED;
+}
+
+uint32_t BusTiming::guard(const BusStream& stream) const {
+	return BUS_TIMING_GUARD + 2 * stream.jitter;
+}
+
+bool BusTiming::clearFor(uint32_t now, uint32_t duration) const {
+	for (const BusStream& stream : streams) {
+		if (!predictable(stream, now)) { continue; }
+
+		uint32_t window = BUS_TIMING_AIRTIME(stream.length) + 2 * guard(stream);
+		if (window + duration >= stream.period) { continue; }    // would never fit, don't starve it
+
+		// the frame due in this period and the next one, relative to `now`
+		uint32_t elapsed = now - stream.lastEnd;
+		for (uint32_t cycle = elapsed / stream.period; cycle <= elapsed / stream.period + 1; cycle++) {
+			if (cycle == 0) { continue; }    // already seen
+			int32_t end = static_cast<int32_t>(cycle * stream.period - elapsed) + guard(stream);
+			int32_t start = end - static_cast<int32_t>(window);
+			if (end > 0 && start < static_cast<int32_t>(duration)) { return false; }
+		}
+	}
+	return true;
+}
+
+void BusTiming::reset() {
+	memset(streams, 0, sizeof(streams));
+}
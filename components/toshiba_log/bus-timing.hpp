@@ -0,0 +1,78 @@
+/*
+bus-timing.hpp - Learned cadence of periodic master frames
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "frame-fixer.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+#define BUS_TIMING_STREAMS (frame_status_update + 1)    // periodic FrameKinds, indexed by kind
+#define BUS_TIMING_MIN_SAMPLES 3                      // intervals before a stream is predicted
+#define BUS_TIMING_MAX_MISSED 4                       // periods without the frame before its cadence is relearned
+#define BUS_TIMING_GUARD 10                           // ms kept clear on either side of a predicted frame
+#define BUS_TIMING_MAX_GUARD 100                      // ms, wider windows mean the cadence isn't known well enough
+#define BUS_TIMING_AIRTIME(len) ((len) * 46 / 10)     // ms, 11 bits per byte at 2400 baud
+
+/**
+* Cadence of one periodic frame kind: smoothed period, its mean deviation
+* and when the last frame was seen, which is the phase: the time the read
+* that delivered its last byte returned, within one loop pass of its end on
+* the bus.
+*/
+struct BusStream {
+	uint32_t lastEnd;    // ms, read time of the last byte
+	uint32_t period;     // ms
+	uint32_t jitter;     // ms
+	uint8_t length;      // bytes
+	uint8_t samples;
+	bool seen;
+};
+
+/**
+* Predicts when the master is about to talk.
+*
+* Heartbeats and the status frames come on a fixed cadence. Every sniffed
+* frame of those kinds updates the period (1/8 of the way to each interval,
+* missed frames divided out) and the phase of its kind, and the deviation
+* of the intervals becomes the jitter. A kind with a steady cadence then
+* predicts a busy window around each of its next frames, widened by twice
+* the jitter. A kind that stops, or whose frames wander by more than
+* `BUS_TIMING_MAX_GUARD` or 1/8 of its period, is left out until it settles
+* again, and an unknown bus is always clear.
+*
+* `clearFor()` tells whether a transmission of the given length, request
+* plus expected response, fits before the next predicted window. Kinds
+* whose gaps are too short for it ever to fit don't block it.
+*/
+class BusTiming {
+  private:
+	BusStream streams[BUS_TIMING_STREAMS];
+
+	bool predictable(const BusStream& stream, uint32_t now) const;
+	uint32_t guard(const BusStream& stream) const;
+
+  public:
+	BusTiming();
+
+	void observe(FrameKind kind, uint32_t end, uint8_t length);
+	bool clearFor(uint32_t now, uint32_t duration) const;
+	const BusStream& stream(FrameKind kind) const { return streams[kind < BUS_TIMING_STREAMS ? kind : frame_unknown]; }
+	bool predictable(FrameKind kind, uint32_t now) const { return predictable(stream(kind), now); }
+	void reset();
+};
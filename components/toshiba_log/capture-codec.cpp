@@ -0,0 +1,188 @@
+/*
+capture-codec.cpp - Protocol-aware compression of bus capture records
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "capture-codec.hpp"
+#include <string.h>
+
+static size_t putVarint(uint32_t value, uint8_t* out) {
+	size_t len = 0;
+	while (value >= 0x80) {
+		out[len++] = value | 0x80;
+		value >>= 7;
+	}
+	out[len++] = value;
+	return len;
+}
+
+static size_t getVarint(const uint8_t* data, size_t len, uint32_t& value) {
+	value = 0;
+	for (size_t idx = 0; idx < len && idx < 5; idx++) {
+		value |= static_cast<uint32_t>(data[idx] & 0x7f) << (7 * idx);
+		if (!(data[idx] & 0x80)) { return idx + 1; }
+	}
+	return 0;
+}
+
+CaptureCodec::CaptureCodec()
+    : previous()
+    , previousFlags()
+    , previousTimestamp(0)
+    , templates(knownFrames.size() < CAPTURE_CODEC_TEMPLATES ? knownFrames.size() : CAPTURE_CODEC_TEMPLATES) {
+}
+
+void CaptureCodec::reset() {
+	memset(previous, 0, sizeof(previous));
+	memset(previousFlags, 0, sizeof(previousFlags));
+	previousTimestamp = 0;
+}
+
+// knownFrames index whose header and length the frame has, CAPTURE_CODEC_LITERAL if none
+uint8_t CaptureCodec::templateOf(const uint8_t* data, uint8_t len) const {
+	if (len < FRAME_DATA_OFFSET || data[0] != FRAME_BEGIN >> 8 || data[1] != (FRAME_BEGIN & 0xff)) { return CAPTURE_CODEC_LITERAL; }
+
+	for (uint8_t id = 0; id < templates; id++) {
+		const KnownFrame& frame = knownFrames[id];
+		if (len == frame.len && data[FRAME_TYPE_OFFSET] == frame.frameType && data[FRAME_DATA_LEN_OFFSET] == frame.dataLen
+		    && (data[FRAME_SRC_OFFSET] << 8 | data[FRAME_SRC_OFFSET + 1]) == frame.src
+		    && (data[FRAME_DST_OFFSET] << 8 | data[FRAME_DST_OFFSET + 1]) == frame.dst
+		    && (data[FRAME_DATA_TYPE_OFFSET] << 8 | data[FRAME_DATA_TYPE_OFFSET + 1]) == frame.dataType) {
+			return id;
+		}
+	}
+	return CAPTURE_CODEC_LITERAL;
+}
+
+uint8_t CaptureCodec::templateLength(uint8_t id) const {
+	return id < templates ? knownFrames[id].len : 0;
+}
+
+size_t CaptureCodec::encode(const CaptureRecord& record, uint8_t* out, size_t outSize) {
+	if (outSize < CAPTURE_CODEC_RECORD_MAX) { return 0; }
+
+	uint8_t id = templateOf(record.data, record.length);
+	uint8_t context = id == CAPTURE_CODEC_LITERAL ? CAPTURE_CODEC_TEMPLATES + record.length : id;
+	uint8_t* last = previous[context];
+	uint8_t coded = record.length;
+	uint8_t head = id;
+	if (record.length >= FRAME_MIN_LEN
+	    && EstiaFrame::crc16(record.data, record.length - 2) == (record.data[record.length - 2] << 8 | record.data[record.length - 1])) {
+		head |= codec_crc_omitted;
+		coded -= FRAME_CRC_LEN;
+	}
+	if (record.flags != previousFlags[context]) { head |= codec_flags; }
+
+	uint8_t masks[(FRAME_MAX_LEN + CAPTURE_CODEC_GROUP - 1) / CAPTURE_CODEC_GROUP] = {};
+	uint8_t groups = 0;
+	for (uint8_t idx = 0; idx < coded; idx++) {
+		if (record.data[idx] == last[idx]) { continue; }
+		masks[idx / CAPTURE_CODEC_GROUP] |= 1 << (idx % CAPTURE_CODEC_GROUP);
+		groups |= 1 << (idx / CAPTURE_CODEC_GROUP);
+	}
+	if (groups) { head |= codec_delta; }
+
+	size_t pos = 0;
+	out[pos++] = head;
+	pos += putVarint(record.timestamp - previousTimestamp, out + pos);
+	if (id == CAPTURE_CODEC_LITERAL) { out[pos++] = record.length; }
+	if (head & codec_flags) { out[pos++] = record.flags; }
+	if (groups) {
+		out[pos++] = groups;
+		for (uint8_t group = 0; group < sizeof(masks); group++) {
+			if (masks[group]) { out[pos++] = masks[group]; }
+		}
+		for (uint8_t idx = 0; idx < coded; idx++) {
+			if (masks[idx / CAPTURE_CODEC_GROUP] & (1 << (idx % CAPTURE_CODEC_GROUP))) { out[pos++] = record.data[idx]; }
+		}
+	}
+
+	memcpy(last, record.data, record.length);
+	previousFlags[context] = record.flags;
+	previousTimestamp = record.timestamp;
+	return pos;
+}
+
+size_t CaptureCodec::decode(const uint8_t* data, size_t len, CaptureRecord& record) {
+	if (len < 2 || data[0] & 0x80) { return 0; }
+
+	uint8_t head = data[0];
+	uint8_t id = head & 0x0f;
+	size_t pos = 1;
+	uint32_t delta;
+	size_t used = getVarint(data + pos, len - pos, delta);
+	if (used == 0) { return 0; }
+	pos += used;
+
+	uint8_t length = templateLength(id);
+	if (id == CAPTURE_CODEC_LITERAL) {
+		if (pos >= len || data[pos] > FRAME_MAX_LEN) { return 0; }
+		length = data[pos++];
+	} else if (length == 0) {
+		return 0;
+	}
+	uint8_t context = id == CAPTURE_CODEC_LITERAL ? CAPTURE_CODEC_TEMPLATES + length : id;
+	uint8_t flags = previousFlags[context];
+	if (head & codec_flags) {
+		if (pos >= len) { return 0; }
+		flags = data[pos++];
+	}
+	if (head & codec_crc_omitted && length < FRAME_CRC_LEN) { return 0; }
+	uint8_t coded = head & codec_crc_omitted ? length - FRAME_CRC_LEN : length;
+
+	uint8_t frame[FRAME_MAX_LEN];
+	memcpy(frame, previous[context], length);
+	if (head & codec_delta) {
+		if (pos >= len) { return 0; }
+		uint8_t groups = data[pos++];
+		uint8_t masks[(FRAME_MAX_LEN + CAPTURE_CODEC_GROUP - 1) / CAPTURE_CODEC_GROUP] = {};
+		for (uint8_t group = 0; group < sizeof(masks); group++) {
+			if (!(groups & (1 << group))) { continue; }
+			if (pos >= len) { return 0; }
+			masks[group] = data[pos++];
+		}
+		for (uint8_t idx = 0; idx < coded; idx++) {
+			if (!(masks[idx / CAPTURE_CODEC_GROUP] & (1 << (idx % CAPTURE_CODEC_GROUP)))) { continue; }
+			if (pos >= len) { return 0; }
+			frame[idx] = data[pos++];
+		}
+	}
+	if (head & codec_crc_omitted) {
+		uint16_t crc = EstiaFrame::crc16(frame, coded);
+		frame[coded] = crc >> 8;
+		frame[coded + 1] = crc;
+	}
+
+	record.timestamp = previousTimestamp + delta;
+	record.flags = flags;
+	record.length = length;
+	memcpy(record.data, frame, length);
+	memcpy(previous[context], frame, length);
+	previousFlags[context] = flags;
+	previousTimestamp = record.timestamp;
+	return pos;
+}
+
+size_t CaptureCodec::sectorHeader(uint8_t* out) {
+	const uint8_t header[CAPTURE_CODEC_SECTOR_HEADER_SIZE] = {'E', 'S', 'T', 'Z', CAPTURE_CODEC_VERSION, CAPTURE_CODEC_MARK};
+	memcpy(out, header, sizeof(header));
+	return sizeof(header);
+}
+
+// a raw record can't have CAPTURE_CODEC_MARK as its length byte
+bool CaptureCodec::isSectorHeader(const uint8_t* data, size_t len) {
+	return len >= CAPTURE_CODEC_SECTOR_HEADER_SIZE && data[5] == CAPTURE_CODEC_MARK && data[4] == CAPTURE_CODEC_VERSION;
+}
@@ -0,0 +1,81 @@
+/*
+capture-codec.hpp - Protocol-aware compression of bus capture records
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "bus-capture.hpp"
+#include "frame-fixer.hpp"
+
+#define CAPTURE_CODEC_TEMPLATES 15                               // knownFrames entries with a template id
+#define CAPTURE_CODEC_LITERAL 0x0f                               // template id of frames matching none
+#define CAPTURE_CODEC_CONTEXTS (CAPTURE_CODEC_TEMPLATES + FRAME_MAX_LEN + 1)    // templates, then literals by length
+#define CAPTURE_CODEC_RECORD_MAX (1 + 5 + 1 + 1 + 1 + 6 + FRAME_MAX_LEN)    // worst case encoded record
+#define CAPTURE_CODEC_GROUP 8                                    // frame bytes per mask byte
+#define CAPTURE_CODEC_MARK 0xfe                                  // byte 5 of an encoded sector header
+#define CAPTURE_CODEC_VERSION 1
+#define CAPTURE_CODEC_SECTOR_HEADER_SIZE 6
+
+// encoded record head bits above the template id
+enum CaptureCodecHead : uint8_t {
+	codec_crc_omitted = 0x10,    // raw CRC matched, recomputed on decode
+	codec_flags = 0x20,          // flags byte follows, else the context's previous flags
+	codec_delta = 0x40,          // changed bytes follow, else identical to the context's previous frame
+};
+
+/**
+* Protocol-aware coder for `CaptureRecord`s.
+*
+* Every frame is coded against the previous frame of its context: the
+* `knownFrames` template its header and length match, or for anything else
+* (requests, commands, fragments) the previous unmatched frame of the same
+* length. Most broadcasts repeat verbatim or differ in a byte or two, and a
+* frame whose raw CRC is valid drops it, so a heartbeat costs its head and
+* timestamp only. Encoded record, varints are LEB128:
+*
+*     u8     head        template id (bits 0-3), `CaptureCodecHead` bits, bit 7 clear
+*     varint timestamp   µs since the previous record
+*     u8     length      only for `CAPTURE_CODEC_LITERAL`
+*     u8     flags       only with `codec_flags`
+*     u8     groups      only with `codec_delta`: bit g set, 8 frame bytes from g*8 have changes
+*     u8     mask[]      one per set group bit: bit b set, byte g*8+b changed
+*     u8     bytes[]     the changed bytes, in frame order
+*
+* The coder is stateful and both sides must see the same records in the same
+* order; `reset()` starts over, which a sink does at every flash sector so
+* sectors decode on their own. A head of 0xff is padding, as in raw streams.
+*/
+class CaptureCodec {
+  private:
+	uint8_t previous[CAPTURE_CODEC_CONTEXTS][FRAME_MAX_LEN];
+	uint8_t previousFlags[CAPTURE_CODEC_CONTEXTS];
+	uint32_t previousTimestamp;
+	uint8_t templates;
+
+	uint8_t templateOf(const uint8_t* data, uint8_t len) const;
+	uint8_t templateLength(uint8_t id) const;
+
+  public:
+	CaptureCodec();
+
+	void reset();
+	size_t encode(const CaptureRecord& record, uint8_t* out, size_t outSize);    // 0 if it does not fit
+	size_t decode(const uint8_t* data, size_t len, CaptureRecord& record);    // bytes used, 0 on padding or truncation
+
+	static size_t sectorHeader(uint8_t* out);
+	static bool isSectorHeader(const uint8_t* data, size_t len);
+};
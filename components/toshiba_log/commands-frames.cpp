@@ -17,6 +17,7 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 */
 
 #include "commands-frames.hpp"
+#include <algorithm>
 
 SetModeFrame::SetModeFrame(uint8_t mode, uint8_t onOff)
     : EstiaFrame::EstiaFrame(FRAME_TYPE_CMD, FRAME_SET_MODE_LEN)
@@ -93,9 +94,9 @@ uint8_t SwitchFrame::operationOnOff(uint8_t onOff) {
 TemperatureFrame::TemperatureFrame(uint8_t zone, uint8_t zone1Temperature, uint8_t zone2Temperature, uint8_t hotWaterTemperature)
     : EstiaFrame::EstiaFrame(FRAME_TYPE_CMD, FRAME_TEMPERATURE_LEN)
     , zone(zone)
-    , zone1Temperature(constrainTemp(zone1Temperature))
-    , zone2Temperature(constrainTemp(zone2Temperature))
-    , hotWaterTemperature(constrainTemp(hotWaterTemperature)) {
+    , zone1Temperature(constrainTemp(zone, zone1Temperature))
+    , zone2Temperature(constrainTemp(zone, zone2Temperature))
+    , hotWaterTemperature(constrainTemp(zone, hotWaterTemperature)) {
 	setSrc(TEMPERATURE_SRC);
 	setDst(TEMPERATURE_DST);
 	setDataType(FRAME_DATA_TYPE_TEMPERATURE_CHANGE);
@@ -115,19 +116,19 @@ TemperatureFrame::TemperatureFrame(uint8_t zone, uint8_t zone1Temperature, uint8
 	}
 }
 
-uint8_t TemperatureFrame::constrainTemp(uint8_t temperature) {
+uint8_t TemperatureFrame::constrainTemp(uint8_t zone, uint8_t temperature) {
 	uint8_t constrained = temperature;
 	switch (zone) {
 	case TEMPERATURE_COOLING_CODE:
-		constrained = constrain(temperature, MIN_COOLING_TEMP, MIN_COOLING_TEMP);
+		constrained = std::min<uint8_t>(std::max<uint8_t>(temperature, MIN_COOLING_TEMP), MIN_COOLING_TEMP);
 		break;
 
 	case TEMPERATURE_HEATING_CODE:
-		constrained = constrain(temperature, MIN_HEATING_TEMP, MAX_HEATING_TEMP);
+		constrained = std::min<uint8_t>(std::max<uint8_t>(temperature, MIN_HEATING_TEMP), MAX_HEATING_TEMP);
 		break;
 
 	case TEMPERATURE_HOT_WATER_CODE:
-		constrained = constrain(temperature, MIN_HOT_WATER_TEMP, MAX_HOT_WATER_TEMP);
+		constrained = std::min<uint8_t>(std::max<uint8_t>(temperature, MIN_HOT_WATER_TEMP), MAX_HOT_WATER_TEMP);
 		break;
 	}
 	return constrained;
@@ -148,17 +149,31 @@ ForcedDefrostFrame::ForcedDefrostFrame(uint8_t onOff)
 }
 
 AckFrame::AckFrame(FrameBuffer&& buffer)
-    : EstiaFrame::EstiaFrame(buffer, FRAME_ACK_LEN) {
-	error = checkFrame(FRAME_TYPE_ACK, FRAME_DATA_TYPE_ACK);
-	if (error == err_ok) {
-		frameCode = readUint16(ACK_FRAME_CODE_OFFSET);
-	}
+    : EstiaFrame::EstiaFrame(std::move(buffer), FRAME_ACK_LEN)
+    , frameCode(0)
+    , error(0) {
+	Ack ack = decode(FrameView(this->buffer));
+	error = ack.error;
+	frameCode = ack.frameCode;
+}
+
+AckFrame::AckFrame(const FrameBuffer& buffer)
+    : EstiaFrame::EstiaFrame(buffer, FRAME_ACK_LEN)
+    , frameCode(0)
+    , error(0) {
+	Ack ack = decode(FrameView(this->buffer));
+	error = ack.error;
+	frameCode = ack.frameCode;
 }
 
-AckFrame::AckFrame(FrameBuffer& buffer)
-    : AckFrame::AckFrame(std::forward<FrameBuffer>(buffer)) {
+Ack AckFrame::decode(const FrameView& frame) {
+	Ack ack = {frame.check(FRAME_TYPE_ACK, FRAME_DATA_TYPE_ACK), 0};
+	if (ack.error == err_ok) {
+		ack.frameCode = frame.readUint16(ACK_FRAME_CODE_OFFSET);
+	}
+	return ack;
 }
 
-AckFrame::AckFrame(ReadBuffer& buffer)
-    : AckFrame::AckFrame(readBuffToFrameBuff(buffer)) {
+Ack AckFrame::decodeUnchecked(const FrameView& frame) {
+	return {err_ok, frame.readUint16(ACK_FRAME_CODE_OFFSET)};
 }
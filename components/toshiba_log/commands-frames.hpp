@@ -19,8 +19,8 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
 #include "config.h"
+#include "frame-view.hpp"
 #include "frame.hpp"
-#include <Arduino.h>
 #include <string>
 #include <unordered_map>
 
@@ -152,11 +152,11 @@ class TemperatureFrame : public EstiaFrame {
 	uint8_t zone2Temperature;
 	uint8_t hotWaterTemperature;
 
-	uint8_t constrainTemp(uint8_t temperature);
-	uint8_t convertTemp(uint8_t temperature);
-
   public:
 	TemperatureFrame(uint8_t zone, uint8_t zone1Temperature, uint8_t zone2Temperature, uint8_t hotWaterTemperature);
+
+	static uint8_t constrainTemp(uint8_t zone, uint8_t temperature);
+	static uint8_t convertTemp(uint8_t temperature);
 };
 
 #define FORCE_DEFROST_SRC FRAME_SRC_DST_REMOTE
@@ -186,13 +186,19 @@ class ForcedDefrostFrame : public EstiaFrame {
 // ack
 // a0 00 18 09 00 08 00 08 00 00 a1 00 41 c1 95 -> frame with data type 0x0041 ack'd
 
+struct Ack {
+	uint8_t error;
+	uint16_t frameCode;
+};
+
 class AckFrame : public EstiaFrame {
-  private:
   public:
 	AckFrame(FrameBuffer&& buffer);
-	AckFrame(FrameBuffer& buffer);
-	AckFrame(ReadBuffer& buffer);
+	AckFrame(const FrameBuffer& buffer);
 
 	uint16_t frameCode;
 	uint8_t error;
+
+	static Ack decode(const FrameView& frame);
+	static Ack decodeUnchecked(const FrameView& frame);    // header and CRC already validated
 };
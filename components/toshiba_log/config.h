@@ -21,6 +21,10 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 
 #define SENSORS_DATA_TO_REQUEST "tc", "twi", "two", "tho", "wf", "lps", "te", "to", "td", "ts", "tl", "cmp", "fan1", "pmv", "hps"
 
+#ifndef ESTIA_CRC_TABLE
+#define ESTIA_CRC_TABLE 256    // CRC kernel: 256 (512 B flash), 16 (32 B flash) or 0 (bitwise)
+#endif
+
 #define TOSHIBA_ESTIA_MODEL 11    // 4kW, 6kW, 8kW, 11kW
 
 #define MIN_COOLING_TEMP 7     // 7-20, (default 7)
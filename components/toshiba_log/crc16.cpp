@@ -0,0 +1,140 @@
+/*
+crc16.cpp - Estia R32 heat pump CRC-16/MCRF4XX engine
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "crc16.hpp"
+#include <array>
+
+template <size_t Size, uint8_t Bits>
+static constexpr std::array<uint16_t, Size> makeCrcTable() {
+	std::array<uint16_t, Size> table = {};
+	for (size_t idx = 0; idx < Size; idx++) {
+		uint16_t crc = idx;
+		for (uint8_t bit = 0; bit < Bits; bit++) {
+			crc = crc & 0x0001 ? (crc >> 1) ^ CRC16_POLY_REFLECTED : crc >> 1;
+		}
+		table[idx] = crc;
+	}
+	return table;
+}
+
+static constexpr std::array<uint16_t, 256> crcTable = makeCrcTable<256, 8>();
+static constexpr std::array<uint16_t, 16> crcNibbleTable = makeCrcTable<16, 4>();
+
+Crc16::Crc16()
+    : crc(CRC16_INIT) {
+}
+
+void Crc16::reset() {
+	crc = CRC16_INIT;
+}
+
+void Crc16::update(uint8_t byte) {
+	crc = update(crc, byte);
+}
+
+void Crc16::update(const uint8_t* data, size_t len) {
+	crc = compute(data, len, crc);
+}
+
+uint16_t Crc16::value() const {
+	return crc;
+}
+
+uint16_t Crc16::update(uint16_t crc, uint8_t byte) {
+#if ESTIA_CRC_TABLE == 256
+	return (crc >> 8) ^ crcTable[(crc ^ byte) & 0xff];
+#elif ESTIA_CRC_TABLE == 16
+	crc = (crc >> 4) ^ crcNibbleTable[(crc ^ byte) & 0x0f];
+	return (crc >> 4) ^ crcNibbleTable[(crc ^ (byte >> 4)) & 0x0f];
+#else
+	crc ^= byte;
+	for (uint8_t bit = 0; bit < 8; bit++) {
+		crc = crc & 0x0001 ? (crc >> 1) ^ CRC16_POLY_REFLECTED : crc >> 1;
+	}
+	return crc;
+#endif
+}
+
+uint16_t Crc16::compute(const uint8_t* data, size_t len, uint16_t crc) {
+#if ESTIA_CRC_TABLE == 256
+	return computeTable(data, len, crc);
+#elif ESTIA_CRC_TABLE == 16
+	return computeNibble(data, len, crc);
+#else
+	return computeBitwise(data, len, crc);
+#endif
+}
+
+uint16_t Crc16::computeBitwise(const uint8_t* data, size_t len, uint16_t crc) {
+	if (!data) { return crc; }
+	while (len--) {
+		crc ^= *data++;
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			crc = crc & 0x0001 ? (crc >> 1) ^ CRC16_POLY_REFLECTED : crc >> 1;
+		}
+	}
+	return crc;
+}
+
+uint16_t Crc16::computeNibble(const uint8_t* data, size_t len, uint16_t crc) {
+	if (!data) { return crc; }
+	while (len--) {
+		uint8_t byte = *data++;
+		crc = (crc >> 4) ^ crcNibbleTable[(crc ^ byte) & 0x0f];
+		crc = (crc >> 4) ^ crcNibbleTable[(crc ^ (byte >> 4)) & 0x0f];
+	}
+	return crc;
+}
+
+uint16_t Crc16::computeTable(const uint8_t* data, size_t len, uint16_t crc) {
+	if (!data) { return crc; }
+	while (len--) {
+		crc = (crc >> 8) ^ crcTable[(crc ^ *data++) & 0xff];
+	}
+	return crc;
+}
+
+FrameCrc::FrameCrc()
+    : crc()
+    , tail{0x00, 0x00}
+    , length(0) {
+}
+
+void FrameCrc::reset() {
+	crc.reset();
+	length = 0;
+}
+
+void FrameCrc::update(uint8_t byte) {
+	if (length >= 2) { crc.update(tail[0]); }
+	tail[0] = tail[1];
+	tail[1] = byte;
+	if (length < UINT8_MAX) { length++; }
+}
+
+bool FrameCrc::valid() const {
+	return length > 2 && crc.value() == ((tail[0] << 8) | tail[1]);
+}
+
+uint16_t FrameCrc::value() const {
+	return crc.value();
+}
+
+uint8_t FrameCrc::size() const {
+	return length;
+}
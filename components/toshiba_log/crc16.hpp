@@ -0,0 +1,77 @@
+/*
+crc16.hpp - Estia R32 heat pump CRC-16/MCRF4XX engine
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "config.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRC16_INIT 0xffff
+#define CRC16_POLY_REFLECTED 0x8408    // 0x1021 reflected
+
+/**
+* CRC-16/MCRF4XX (poly 0x1021 reflected, init 0xffff, no final xor).
+*
+* The kernel used by `compute()`/`update()` is selected with `ESTIA_CRC_TABLE`
+* (`config.h`, or `-DESTIA_CRC_TABLE=` in `build_flags`): `256` (byte table,
+* 512 B flash), `16` (nibble table, 32 B flash) or `0` (bitwise, no table).
+* All kernels stay callable for benchmarking; unused tables are dropped by
+* the linker.
+*/
+class Crc16 {
+  private:
+	uint16_t crc;
+
+  public:
+	Crc16();
+
+	void reset();
+	void update(uint8_t byte);
+	void update(const uint8_t* data, size_t len);
+	uint16_t value() const;
+
+	static uint16_t update(uint16_t crc, uint8_t byte);
+	static uint16_t compute(const uint8_t* data, size_t len, uint16_t crc = CRC16_INIT);
+	static uint16_t computeBitwise(const uint8_t* data, size_t len, uint16_t crc = CRC16_INIT);
+	static uint16_t computeNibble(const uint8_t* data, size_t len, uint16_t crc = CRC16_INIT);
+	static uint16_t computeTable(const uint8_t* data, size_t len, uint16_t crc = CRC16_INIT);
+};
+
+/**
+* Running frame check fed one byte at a time as it arrives from the UART.
+*
+* Keeps the CRC over everything but the last two bytes plus those two bytes,
+* so `valid()` tells whether the bytes seen so far form a frame with a
+* correct trailing CRC in O(1), the instant the last byte lands.
+*/
+class FrameCrc {
+  private:
+	Crc16 crc;
+	uint8_t tail[2];
+	uint8_t length;
+
+  public:
+	FrameCrc();
+
+	void reset();
+	void update(uint8_t byte);
+	bool valid() const;
+	uint16_t value() const;    // CRC over all but the last two bytes
+	uint8_t size() const;
+};
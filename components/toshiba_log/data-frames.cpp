@@ -36,28 +36,37 @@ DataReqFrame::DataReqFrame(uint8_t requestCode)
 }
 
 DataResFrame::DataResFrame(FrameBuffer&& buffer)
-    : EstiaFrame::EstiaFrame(buffer, FRAME_RES_DATA_LEN)
+    : EstiaFrame::EstiaFrame(std::move(buffer), FRAME_RES_DATA_LEN)
     , error(0)
     , value(0) {
-	error = checkFrame();
-	if (error == err_ok) {
-		value = readUint16(RES_DATA_VALUE_OFFSET);
-	}
+	DataResponse response = decode(FrameView(this->buffer));
+	error = response.error;
+	value = response.value;
 }
 
-DataResFrame::DataResFrame(FrameBuffer& buffer)
-    : DataResFrame::DataResFrame(std::forward<FrameBuffer>(buffer)) {
-}
-
-DataResFrame::DataResFrame(ReadBuffer& buffer)
-    : DataResFrame::DataResFrame(readBuffToFrameBuff(buffer)) {
+DataResFrame::DataResFrame(const FrameBuffer& buffer)
+    : EstiaFrame::EstiaFrame(buffer, FRAME_RES_DATA_LEN)
+    , error(0)
+    , value(0) {
+	DataResponse response = decode(FrameView(this->buffer));
+	error = response.error;
+	value = response.value;
 }
 
-uint8_t DataResFrame::checkFrame() {
-	uint8_t error = EstiaFrame::checkFrame(FRAME_TYPE_RES_DATA, FRAME_DATA_TYPE_DATA_RESPONSE);
-	if (error != err_ok) { return error; }
+// payload: 00 80 flag(2) value(2)
+DataResponse DataResFrame::decode(const FrameView& frame) {
+	DataResponse response = {frame.check(FRAME_TYPE_RES_DATA, FRAME_DATA_TYPE_DATA_RESPONSE), 0};
+	if (response.error != err_ok) { return response; }
 
-	if (readUint16(RES_DATA_EMPTY_OFFSET) == RES_DATA_FLAG_EMPTY) { return err_data_empty; }
+	return decodeUnchecked(frame);
+}
 
-	return err_ok;
+DataResponse DataResFrame::decodeUnchecked(const FrameView& frame) {
+	DataResponse response = {err_ok, 0};
+	if (frame.readUint16(RES_DATA_EMPTY_OFFSET) == RES_DATA_FLAG_EMPTY) {
+		response.error = err_data_empty;
+		return response;
+	}
+	response.value = static_cast<int16_t>(frame.readUint16(RES_DATA_VALUE_OFFSET));
+	return response;
 }
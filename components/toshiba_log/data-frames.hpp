@@ -18,6 +18,7 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include "frame-view.hpp"
 #include "frame.hpp"
 #include <string>
 #include <unordered_map>
@@ -92,6 +93,14 @@ enum RequestCode {
 	CODE_BOOST_HEATER_ON_TIME = 0xf7,     // x1/100 h boosterEHeaterAccumulationTime
 };
 
+// every RequestCode above, request frames for these are tabled at compile time
+#define REQUEST_CODES \
+	CODE_TC, CODE_TWI, CODE_TWO, CODE_THO, CODE_TFI, CODE_TTW, CODE_MIX, CODE_LPS, CODE_SW_VER, \
+	    CODE_CTRL_HW_TEMP, CODE_CTRL_ZONE1_TEMP, CODE_CTRL_ZONE2_TEMP, CODE_WF, \
+	    CODE_TE, CODE_TO, CODE_TD, CODE_TS, CODE_THS, CODE_CT, CODE_TL, CODE_CMP, CODE_FAN1, CODE_FAN2, CODE_PMV, CODE_HPS, \
+	    CODE_HP_ON_TIME, CODE_HW_CMP_ON_TIME, CODE_COOL_CMP_ON_TIME, CODE_HEAT_CMP_ON_TIME, CODE_PUMP1_ON_TIME, \
+	    CODE_HW_E_HEATER_ON_TIME, CODE_BACKUP_HEATER_ON_TIME, CODE_BOOST_HEATER_ON_TIME
+
 /**
 * @param name requested data name
 * @param code data code
@@ -139,19 +148,23 @@ const RequestsMap requestsMap = {
 #define RES_DATA_FLAG_EMPTY 0x00a2
 #define RES_DATA_FLAG_NOT_EMPTY 0x002c
 
-class DataResFrame : public EstiaFrame {
-  private:
-	uint8_t checkFrame();
+struct DataResponse {
+	uint8_t error;
+	int16_t value;
+};
 
+class DataResFrame : public EstiaFrame {
   public:
 	enum Error {
 		err_data_empty = err_other,
 	};
 
 	DataResFrame(FrameBuffer&& buffer);
-	DataResFrame(FrameBuffer& buffer);
-	DataResFrame(ReadBuffer& buffer);
+	DataResFrame(const FrameBuffer& buffer);
 
 	uint8_t error;
 	int16_t value;
+
+	static DataResponse decode(const FrameView& frame);
+	static DataResponse decodeUnchecked(const FrameView& frame);    // header and CRC already validated
 };
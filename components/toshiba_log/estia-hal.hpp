@@ -0,0 +1,50 @@
+/*
+estia-hal.hpp - Estia R32 heat pump serial hardware abstraction
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+* Byte source/sink the bus engine talks to.
+*
+* On target this wraps the ESPHome UART (see `toshiba_log_hal.h`), on host
+* it is backed by memory buffers, files or a simulated bus.
+*/
+class EstiaUart {
+  public:
+	virtual ~EstiaUart() = default;
+
+	virtual int available() = 0;
+	virtual uint8_t read() = 0;
+	virtual void write(const uint8_t* data, size_t len) = 0;
+	virtual void flush() = 0;    // block until written bytes are clocked out
+};
+
+/**
+* Monotonic millisecond and microsecond clock and sleep.
+*/
+class EstiaClock {
+  public:
+	virtual ~EstiaClock() = default;
+
+	virtual uint32_t millis() = 0;
+	virtual uint32_t micros() = 0;    // wraps after ~71 min
+	virtual void delay(uint32_t ms) = 0;
+};
@@ -19,24 +19,18 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 #include "estia-serial.hpp"
 #include <cstring>
 
-SensorData::SensorData(int16_t value, const float multiplier)
-    : value(value)
-    , multiplier(multiplier) {
-}
-
-
-EstiaSerial::EstiaSerial(esphome::uart::UARTDevice &uart)
-    : serial(uart)
-    , newSensorsData(false)
+EstiaSerial::EstiaSerial(EstiaUart& uart, EstiaClock& clock)
+    : sensorsData()
     , requestSent(false)
     , requestQueue()
     , requestTimer(0)
     , requestRetry(0)
+    , requestTiming(REQUEST_TIMEOUT, REQUEST_DELAY)
+    , busTiming()
     , snifferBuffer()
-    , sniffedFrame()
+    , readTimer(0)
     , sniffedFrames()
-    , frameAck(0)
-    , newStatusData(false)
+    , frameSync(sniffedFrames)
     , statusData()
     , cmdSent(false)
     , cmdQueue()
@@ -45,8 +39,20 @@ EstiaSerial::EstiaSerial(esphome::uart::UARTDevice &uart)
     , txEchoLen(0)
     , txEchoIndex(0)
     , txEchoDeadline(0)
+    , txEchoBroken(false)
+    , syncRequestCode(0)
+    , syncRequestSent(false)
+    , syncRequestDone(false)
+    , syncRequestTimer(0)
+    , syncRequestValue(0)
+    , serial(uart)
+    , clock(clock)
     , frameFixer()
-    , sensorsData() {
+    , frameClassifier()
+    , capture(nullptr)
+    , frameAck(0)
+    , newStatusData(false)
+    , newSensorsData(false) {
 }
 
 void EstiaSerial::begin() {
@@ -55,46 +61,59 @@ void EstiaSerial::begin() {
 }
 
 EstiaSerial::SnifferState EstiaSerial::sniffer() {
-	static u_long readTimer = 0;
-	bool timeout = !snifferBuffer.empty() && millis() - readTimer >= ESTIA_SERIAL_READ_TIMEOUT;
-	if (serial.available() >= ESTIA_SERIAL_MIN_AVAILABLE || timeout) {
-		bool newFrame = this->read(snifferBuffer);
-		readTimer = millis();
-		if (this->splitSnifferBuffer(newFrame || timeout)) {
-			for (auto& frame : sniffedFrames) {
-				frameFixer.fixFrame(frame);
-				if (EstiaFrame::readUint16(frame, 0) != FRAME_BEGIN) { continue; }
-				if (decodeStatus(frame)) { continue; }
-				if (decodeAck(frame)) { continue; }
-				decodeResponse(frame);
+	// bus silent for a few byte times with a frame still open: it ended short
+	bool gap = frameSync.pending() && clock.millis() - readTimer >= ESTIA_SERIAL_FRAME_GAP;
+	if (serial.available() || gap) {
+		if (this->read(snifferBuffer)) {
+			readTimer = clock.millis();
+			gap = false;
+		}
+		this->syncSnifferBuffer(gap);
+		FrameClass* frameClass;
+		while (FrameBuffer* frame = sniffedFrames.nextUndecoded(&frameClass)) {
+			if (capture) {
+				capture->record(clock.micros(), txEchoBroken ? capture_echo : 0, frame->data(), frame->size());
+				txEchoBroken = false;
+			}
+			bool crcValid = frameFixer.fixFrame(*frame);
+			if (capture) {
+				uint8_t outcome = BusCapture::outcome(crcValid, frameFixer.lastFix());
+				capture->amendLast((crcValid ? capture_crc_valid : 0) | outcome << CAPTURE_FIX_SHIFT);
+			}
+			FrameView view(*frame);
+			*frameClass = frameClassifier.classify(view, crcValid);
+			// readTimer: when the frame's last byte was read, a frame ended by the gap was read passes ago
+			busTiming.observe(frameClass->kind, readTimer, frame->size());
+			switch (frameClass->kind) {
+				case frame_status:
+				case frame_status_update:
+					if (frameClass->valid()) { decodeStatus(view); }
+					break;
+				case frame_ack:
+					if (frameClass->valid()) { decodeAck(view); }
+					break;
+				case frame_data_response:
+					decodeResponse(view, frameClass->error);
+					break;
+				default:
+					break;
 			}
 		}
 	}
 	if (!sniffedFrames.empty()) { return sniff_frame_pending; }
-	if (!snifferBuffer.empty() || serial.available()) { return sniff_busy; }
+	if (frameSync.pending() || serial.available()) { return sniff_busy; }
 	if (sendCommand()) { return sniff_busy; }
 	if (sendRequest()) { return sniff_busy; }
 	return sniff_idle;
 }
 
-FrameBuffer EstiaSerial::getSniffedFrame() {
-	FrameBuffer frame;
-	if (!sniffedFrames.empty()) {
-		frame = sniffedFrames.front();
-		sniffedFrames.pop_front();
-	}
-	return frame;
+SniffedFrame EstiaSerial::getSniffedFrame() {
+	return sniffedFrames.pop();
 }
 
-bool EstiaSerial::decodeStatus(FrameBuffer& buffer) {
-	if (!(EstiaFrame::isStatusFrame(buffer) || EstiaFrame::isStatusUpdateFrame(buffer))) { return false; }
-
-	StatusFrame statusFrame(buffer, buffer.size());
-	if (statusFrame.error == StatusFrame::err_ok) {
-		statusData = statusFrame.decode();
-		newStatusData = true;
-	}
-	return true;
+void EstiaSerial::decodeStatus(const FrameView& frame) {
+	statusData = StatusFrame::decodeUnchecked(frame);
+	newStatusData = true;
 }
 
 StatusData& EstiaSerial::getStatusData() {
@@ -102,29 +121,50 @@ StatusData& EstiaSerial::getStatusData() {
 	return statusData;
 }
 
-EstiaData& EstiaSerial::getSensorsData() {
+SensorRegistry& EstiaSerial::getSensorsData() {
 	newSensorsData = false;
 	return sensorsData;
 }
 
-bool EstiaSerial::decodeAck(FrameBuffer& buffer) {
-	if (!EstiaFrame::isAckFrame(buffer)) { return false; }
+SensorRegistry& EstiaSerial::getSensorRegistry() {
+	return sensorsData;
+}
+
+const FrameFixer& EstiaSerial::getFrameFixer() const {
+	return frameFixer;
+}
+
+const RequestTiming& EstiaSerial::getRequestTiming() const {
+	return requestTiming;
+}
+
+const BusTiming& EstiaSerial::getBusTiming() const {
+	return busTiming;
+}
 
-	AckFrame ackFrame(buffer);
-	if (ackFrame.error != StatusFrame::err_ok) { return true; }
+// bus time a request holds: its own airtime and the expected response
+uint32_t EstiaSerial::requestSlot(uint8_t requestCode) const {
+	return BUS_TIMING_AIRTIME(FRAME_REQ_DATA_LEN) + requestTiming.expected(requestCode);
+}
+
+// record sniffed and sent frames into `capture`, nullptr stops recording
+void EstiaSerial::setCapture(BusCapture* capture) {
+	this->capture = capture;
+}
 
-	frameAck = ackFrame.frameCode;
+void EstiaSerial::decodeAck(const FrameView& frame) {
+	Ack ack = AckFrame::decodeUnchecked(frame);
+	frameAck = ack.frameCode;
 
 	// command received, remove from queue
-	if (cmdSent && ackFrame.frameCode == cmdQueue.front().dataType) {
+	if (cmdSent && ack.frameCode == cmdQueue.front().dataType) {
 		cmdQueue.pop_front();
 		cmdRetry = 0;
 		cmdSent = false;
 	}
-	return true;
 }
 
-void EstiaSerial::queueCommand(EstiaFrame& command) {
+void EstiaSerial::queueCommand(const TxFrame& command) {
 	if (cmdQueue.size() >= CMD_QUEUE_SIZE) { return; }
 
 	cmdQueue.push_back(command);
@@ -132,7 +172,7 @@ void EstiaSerial::queueCommand(EstiaFrame& command) {
 
 bool EstiaSerial::sendCommand() {
 	// clear flag to resend command
-	if (cmdSent && millis() - cmdTimer > CMD_TIMEOUT) {
+	if (cmdSent && clock.millis() - cmdTimer > CMD_TIMEOUT) {
 		cmdRetry++;
 		if (cmdRetry > CMD_RETRIES) {
 			cmdQueue.pop_front();
@@ -141,9 +181,12 @@ bool EstiaSerial::sendCommand() {
 		cmdSent = false;
 	}
 	if (!cmdSent && !cmdQueue.empty()) {
+		// room for the command, the master's turnaround and its ack
+		uint32_t slot = BUS_TIMING_AIRTIME(cmdQueue.front().size() + FRAME_ACK_LEN) + requestTiming.delay();
+		if (!busTiming.clearFor(clock.millis(), slot)) { return false; }
 		cmdSent = true;
 		this->write(cmdQueue.front(), false);
-		cmdTimer = millis();
+		cmdTimer = clock.millis();
 		return true;
 	}
 	return false;
@@ -158,16 +201,13 @@ uint16_t EstiaSerial::getAck() {
 bool EstiaSerial::sendRequest() {
 	if (requestQueue.empty()) { return false; }
 
-	// discard invalid requests
-	while (requestsMap.count(requestQueue.front()) == 0) {
-		requestQueue.pop_front();
-		if (requestQueue.empty()) { break; }
-	}
+	uint8_t code = SensorRegistry::code(requestQueue.front());
 	// request timeout
-	if (requestSent && !requestQueue.empty() && millis() - requestTimer >= (requestRetry + 1) * REQUEST_TIMEOUT) {
+	if (requestSent && clock.millis() - requestTimer >= requestTiming.timeout(code)) {
+		requestTiming.timedOut();
 		requestRetry++;
 		if (requestRetry > REQUEST_RETRIES) {
-			saveSensorData(err_timeout);
+			saveSensorData(requestQueue.front(), err_timeout);
 			requestQueue.pop_front();
 			requestRetry = 0;
 		}
@@ -176,32 +216,51 @@ bool EstiaSerial::sendRequest() {
 	// last queue element was popped
 	if (requestQueue.empty()) {
 		newSensorsData = true;
+		return false;
 	}
-	if (!requestSent && !requestQueue.empty() && !cmdSent && millis() - requestTimer >= REQUEST_DELAY) {
-		this->write(DataReqFrame(requestsMap.at(requestQueue.front()).code));
-		requestTimer = millis();
+	if (!requestSent && !cmdSent && !syncRequestSent && clock.millis() - requestTimer >= requestTiming.delay()) {
+		code = SensorRegistry::code(requestQueue.front());
+		if (!busTiming.clearFor(clock.millis(), requestSlot(code))) { return false; }
+		this->write(FrameTables::request(code));
+		requestTimer = clock.millis();
 		requestSent = true;
 		return true;
 	}
 	return false;
 }
 
-bool EstiaSerial::decodeResponse(FrameBuffer& buffer) {
-	if (!EstiaFrame::isDataResFrame(buffer)) { return false; }
-	if (requestQueue.empty()) { return true; }
+// `error` is the CRC verdict of the classifier, a corrupted response still
+// counts as an answer to the pending request
+void EstiaSerial::decodeResponse(const FrameView& frame, uint8_t error) {
+	DataResponse response = {error, 0};
+	if (error == EstiaFrame::err_ok) { response = DataResFrame::decodeUnchecked(frame); }
+	if (syncRequestSent) {
+		requestTiming.sample(syncRequestCode, clock.millis() - syncRequestTimer);
+		syncRequestValue = response.error == DataResFrame::err_ok ? response.value : err_timeout + -response.error;
+		syncRequestSent = false;
+		syncRequestDone = true;
+		syncRequestTimer = clock.millis();
+		uint8_t ordinal = SensorRegistry::ordinal(syncRequestCode);
+		if (ordinal != SENSOR_NONE) { saveSyncData(ordinal, syncRequestValue); }
+		return;
+	}
+	if (requestQueue.empty()) { return; }
 
-	requestTimer = millis();
-	DataResFrame resFrame(buffer);
-	if (resFrame.error != DataResFrame::err_ok) {
-		resFrame.value = err_timeout + -resFrame.error;
+	// only the first attempt is unambiguous, a retry may be answered late by an earlier one
+	if (requestSent && requestRetry == 0) {
+		requestTiming.sample(SensorRegistry::code(requestQueue.front()), clock.millis() - requestTimer);
+	}
+	requestTimer = clock.millis();
+	if (response.error != DataResFrame::err_ok) {
+		response.value = err_timeout + -response.error;
 		requestRetry++;
 		if (requestRetry <= REQUEST_RETRIES) {
 			requestSent = false;
-			return true;
+			return;
 		}
 	}
 
-	saveSensorData(resFrame.value);
+	saveSensorData(requestQueue.front(), response.value);
 
 	// remove request from queue
 	requestQueue.pop_front();
@@ -211,122 +270,103 @@ bool EstiaSerial::decodeResponse(FrameBuffer& buffer) {
 	if (requestQueue.empty()) {
 		newSensorsData = true;
 	}
-	return true;
 }
 
-void EstiaSerial::saveSensorData(uint16_t data) {
-	if (sensorsData.count(requestQueue.front()) == 1) {
-		sensorsData.at(requestQueue.front()).value = data;
-	} else {
-		sensorsData.emplace(requestQueue.front(), SensorData(data, requestsMap.at(requestQueue.front()).multiplier));
+void EstiaSerial::saveSensorData(uint8_t ordinal, int16_t data) {
+	SensorStatus status = sensor_failed;
+	if (data > err_not_exist) {
+		status = sensor_valid;
+	} else if (data == err_data_empty) {
+		status = sensor_empty;
 	}
+	sensorsData.store(ordinal, data, status, clock.millis());
 }
 
-bool EstiaSerial::splitSnifferBuffer(bool ignoreMinLen) {
-	if (!ignoreMinLen && snifferBuffer.size() < FRAME_MIN_LEN) { return false; }
+// requestData() doesn't retry, its caller asks again: like a queued request,
+// an error only replaces the value after REQUEST_RETRIES + 1 failures in a row
+void EstiaSerial::saveSyncData(uint8_t ordinal, int16_t data) {
+	SensorSlot& slot = sensorsData[ordinal];
+	bool failed = data <= err_not_exist && data != err_data_empty;
+	if (failed && slot.failures < REQUEST_RETRIES) {
+		slot.failures++;
+		return;
+	}
+	saveSensorData(ordinal, data);
+}
 
-	uint8_t frameSize = 0;
-	while (!snifferBuffer.empty()) {
-		// calculate expected frame length from data
-		if (frameSize == 0 && sniffedFrame.size() >= FRAME_HEAD_LEN
-		    && EstiaFrame::readUint16(sniffedFrame, 0) == FRAME_BEGIN) {
-			frameSize = sniffedFrame.at(FRAME_DATA_LEN_OFFSET) + FRAME_HEAD_AND_CRC_LEN;
+// feed buffered bytes through the frame synchronizer, complete frames land in sniffedFrames
+void EstiaSerial::syncSnifferBuffer(bool flush) {
+	for (const ReadBuffer::Span& span : {snifferBuffer.first(), snifferBuffer.second()}) {
+		for (size_t idx = 0; idx < span.size; idx++) {
+			frameSync.push(span.data[idx]);
 		}
-		// next frame begin detected in sniffer buffer
-		if (!sniffedFrame.empty() && EstiaFrame::readUint16(snifferBuffer, 0) == FRAME_BEGIN) {
-			// frame shorter than expected and shorter than max
-			if (sniffedFrame.size() < frameSize && frameSize <= FRAME_MAX_LEN
-			    && sniffedFrame.size() <= FRAME_MAX_LEN) {
-				// read remaining data
-				this->read(snifferBuffer);
-				// push 0xa0 byte to current frame
-				sniffedFrame.push_back(snifferBuffer.front());
-				snifferBuffer.pop_front();
-				// and continue
-				continue;
-			}
-			// next frame has already begun in sniffer buffer
-			break;
-		}
-		// check for joined two frames (first probably malformed)
-		if (frameSize != 0 && sniffedFrame.size() > frameSize) {
-			// check sniffed frame for next frame begin byte (skip first byte)
-			for (uint8_t idx = 1; idx < sniffedFrame.size(); idx++) {
-				if (EstiaFrame::readUint16(sniffedFrame, idx) == FRAME_BEGIN) {
-					FrameBuffer firstFrame(sniffedFrame.begin(), sniffedFrame.begin() + idx);
-					sniffedFrame.erase(sniffedFrame.begin(), sniffedFrame.begin() + idx);
-					sniffedFrames.push_back(firstFrame);
-					frameSize = 0;
-					break;
-				}
-			}
-		}
-		sniffedFrame.push_back(snifferBuffer.front());
-		snifferBuffer.pop_front();
-	}
-	sniffedFrames.push_back(sniffedFrame);
-	while (sniffedFrames.size() >= SNIFFED_FRAMES_LIMIT) {
-		sniffedFrames.pop_front();
 	}
-	sniffedFrame.clear();
-
-	return true;
+	snifferBuffer.clear();
+	if (flush) { frameSync.flush(); }
 }
 
+/** Single data request outside the request queue, non-blocking.
+*
+* Sends the request on the first call and returns `err_pending` until the
+* response was decoded by `sniffer()`, then returns the value once. Call it
+* again from the loop with the same code to poll.
+*/
 int16_t EstiaSerial::requestData(uint8_t requestCode) {
-	DataReqFrame request(requestCode);
-	this->write(request);    //send request
-	uint32_t responseTimeoutTimer = millis();
-	while (!serial.available()) {    // wait for response
-		if (millis() - responseTimeoutTimer > REQUEST_TIMEOUT) { return err_timeout; }
-		delay(ESTIA_SERIAL_BYTE_DELAY);
+	if (syncRequestDone) {
+		syncRequestDone = false;
+		if (syncRequestCode == requestCode) { return syncRequestValue; }
 	}
-	delay(ESTIA_SERIAL_BYTE_DELAY * 2);    // 2 bytes head start
-	splitSnifferBuffer();                  // read out data in buffer
-	snifferBuffer.clear();
-	this->read(snifferBuffer);
-	DataResFrame response(snifferBuffer);
-	if (response.error != DataResFrame::err_ok) { return err_timeout + -response.error; }
-	return response.value;
+	if (syncRequestSent) {
+		if (clock.millis() - syncRequestTimer < requestTiming.timeout(syncRequestCode)) { return err_pending; }
+		requestTiming.timedOut();
+		syncRequestSent = false;
+		uint8_t ordinal = SensorRegistry::ordinal(syncRequestCode);
+		if (ordinal != SENSOR_NONE) { saveSyncData(ordinal, err_timeout); }
+		if (syncRequestCode == requestCode) { return err_timeout; }
+	}
+	if (requestSent || cmdSent || frameSync.pending()) { return err_pending; }    // bus busy, try next loop
+	uint32_t spacing = requestTiming.delay();
+	if (clock.millis() - requestTimer < spacing || clock.millis() - syncRequestTimer < spacing) {
+		return err_pending;    // keep the same spacing as queued requests
+	}
+	if (!busTiming.clearFor(clock.millis(), requestSlot(requestCode))) { return err_pending; }
+
+	this->write(FrameTables::request(requestCode));
+	syncRequestCode = requestCode;
+	syncRequestSent = true;
+	syncRequestTimer = clock.millis();
+	return err_pending;
 }
 
 int16_t EstiaSerial::requestData(std::string request) {
-	if (requestsMap.count(request) == 1) {
-		return requestData((requestsMap.at(request)).code);
-	}
-	return err_not_exist;
+	uint8_t ordinal = SensorRegistry::ordinal(request);
+	if (ordinal == SENSOR_NONE) { return err_not_exist; }
+	return requestData(SensorRegistry::code(ordinal));
 }
 
 void EstiaSerial::clearSensorsData() {
 	sensorsData.clear();
 }
 
-bool EstiaSerial::requestSensorsData(DataToRequest&& sensorsToRequest, bool clear) {
+bool EstiaSerial::requestSensorsData(const SensorList& sensorsToRequest, bool clear) {
 	if (!requestQueue.empty()) { return false; }    // request in progress
 
 	newSensorsData = false;
 	if (clear) { clearSensorsData(); }
-	for (auto& sensor : sensorsToRequest) {
-		if (requestsMap.count(sensor) == 0) {
-			continue;
-		}
-		requestQueue.push_back(sensor);
+	for (uint8_t ordinal : sensorsToRequest) {
+		if (ordinal >= SensorRegistry::size()) { continue; }
+		requestQueue.push_back(ordinal);
 	}
 	return true;
 }
 
-bool EstiaSerial::requestSensorsData(DataToRequest& sensorsToRequest, bool clear) {
-	return requestSensorsData(std::forward<DataToRequest>(sensorsToRequest), clear);
-}
-
 /**
 * @param mode `auto` `quiet` `night`
 * @param onOff `1` `0`
 */
 void EstiaSerial::modeSwitch(std::string mode, uint8_t onOff) {
 	if (modeByName.count(mode) == 0) { return; }
-	SetModeFrame modeFrame(mode, onOff);
-	this->queueCommand(modeFrame);
+	this->queueCommand(FrameTables::mode(modeByName.at(mode), onOff));
 }
 
 /**
@@ -335,8 +375,7 @@ void EstiaSerial::modeSwitch(std::string mode, uint8_t onOff) {
 void EstiaSerial::setOperationMode(std::string mode) {
 	if (operationModeByName.count(mode) == 0) { return; }
 
-	OperationMode operationMode(mode);
-	this->queueCommand(operationMode);
+	this->queueCommand(FrameTables::operationMode(operationModeByName.at(mode)));
 }
 
 /**
@@ -350,8 +389,7 @@ void EstiaSerial::operationSwitch(std::string operation, uint8_t onOff) {
 	if (operationModeByName.count(operation) != 0 && statusData.operationMode != operationModeByName.at(operation)) {
 		setOperationMode(operation);
 	}
-	SwitchFrame switchFrame(operation, onOff);
-	this->queueCommand(switchFrame);
+	this->queueCommand(FrameTables::operationSwitch(switchOperationByName.at(operation), onOff));
 }
 
 /**
@@ -386,8 +424,7 @@ void EstiaSerial::setTemperature(std::string zone, uint8_t temperature) {
 		hotWater = temperature;
 		break;
 	}
-	TemperatureFrame temperatureFrame(temperatureByName.at(zone), zone1, zone2, hotWater);
-	this->queueCommand(temperatureFrame);
+	this->queueCommand(FrameTables::temperature(temperatureByName.at(zone), zone1, zone2, hotWater));
 }
 
 /** Force defrost on next operation start (heating or hot water).
@@ -397,8 +434,7 @@ void EstiaSerial::setTemperature(std::string zone, uint8_t temperature) {
 * @param onOff `1` `0`
 */
 void EstiaSerial::forceDefrost(uint8_t onOff) {
-	ForcedDefrostFrame defrostFrame(onOff);
-	this->queueCommand(defrostFrame);
+	this->queueCommand(FrameTables::forceDefrost(onOff));
 }
 
 void EstiaSerial::write(const uint8_t* buffer, uint8_t len, bool disableRx) {
@@ -412,11 +448,14 @@ void EstiaSerial::write(const uint8_t* buffer, uint8_t len, bool disableRx) {
 		memcpy(txEchoBuffer, buffer, echoLen);
 		txEchoLen = echoLen;
 		txEchoIndex = 0;
-		txEchoDeadline = millis() + (ESTIA_SERIAL_BYTE_DELAY * echoLen) + ESTIA_SERIAL_TX_ECHO_MARGIN;
 	}
-	serial.write_array(buffer, len);
+	if (capture) { capture->record(clock.micros(), capture_tx | (disableRx ? capture_echo : 0), buffer, len); }
+	serial.write(buffer, len);
 	if (disableRx) {
 		serial.flush();    // block until the frame above is fully clocked out
+		// the whole echo is in the RX FIFO now and read() drains it on the
+		// following loop passes, so the window starts here, not before the flush
+		txEchoDeadline = clock.millis() + (ESTIA_SERIAL_BYTE_DELAY * txEchoLen) + ESTIA_SERIAL_TX_ECHO_MARGIN;
 	}
 }
 
@@ -425,33 +464,31 @@ void EstiaSerial::write(const Frame& frame, bool disableRx) {
 	this->write(frame.data(), frame.size(), disableRx);
 }
 
-bool EstiaSerial::read(ReadBuffer& buffer, bool byteDelay) {
-	if (!serial.available()) { return false; }
-
+// drain whatever the UART holds without waiting for more, true if any byte was read
+bool EstiaSerial::read(ReadBuffer& buffer) {
+	bool received = false;
 	while (serial.available()) {
+		if (buffer.full()) { break; }    // leave the rest in the UART FIFO until the framer catches up
 		uint8_t b = serial.read();
+		received = true;
 
 		if (txEchoLen > 0) {
-			if (millis() > txEchoDeadline) {
+			if (static_cast<int32_t>(clock.millis() - txEchoDeadline) > 0) {
 				txEchoLen = 0;    // echo window missed/expired, treat as live bus data below
 			} else if (b == txEchoBuffer[txEchoIndex]) {
 				txEchoIndex++;
 				if (txEchoIndex >= txEchoLen) { txEchoLen = 0; }    // full echo consumed
-				if (byteDelay) { delay(ESTIA_SERIAL_BYTE_DELAY); }
 				continue;    // our own transmitted byte, don't feed it into the sniffer
 			} else {
 				// mismatch mid-echo: either a genuine bus collision or the bus
 				// doesn't echo at all. Stop suppressing and let this byte (and
 				// everything after it) flow through as normal sniffed data.
 				txEchoLen = 0;
+				txEchoBroken = true;
 			}
 		}
 
 		buffer.push_back(b);
-		if (byteDelay) { delay(ESTIA_SERIAL_BYTE_DELAY); }
-		if (buffer.size() > 2 && EstiaFrame::readUint16(buffer, buffer.size() - 2) == FRAME_BEGIN) {    // new frame already began
-			break;
-		}
 	}
-	return static_cast<bool>(serial.available());
+	return received;
 }
@@ -17,29 +17,28 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 */
 
 #pragma once
-#include "esphome/core/component.h"
-#include "esphome/components/uart/uart.h"
 #include "config.h"
+#include "bus-capture.hpp"
+#include "bus-timing.hpp"
 #include "commands-frames.hpp"
 #include "data-frames.hpp"
+#include "estia-hal.hpp"
+#include "frame-classifier.hpp"
 #include "frame-fixer.hpp"
+#include "frame-sync.hpp"
+#include "frame-tables.hpp"
+#include "request-timing.hpp"
+#include "sensor-registry.hpp"
 #include "status-frames.hpp"
-#include <deque>
-#include <map>
 #include <string>
 
 #define ESTIA_SERIAL_BAUD 2400              // 2400
 #define ESTIA_SERIAL_CONFIG SERIAL_8E1    // 8E1
-#ifdef ARDUINO_ARCH_ESP32
-#endif
 #define ESTIA_SERIAL_BYTE_DELAY 5        // 4.2 ms minimum for baud 2400
-#define ESTIA_SERIAL_READ_TIMEOUT 190    // maximum valid frame is 45 Bytes so max 189ms transmit time
-#define ESTIA_SERIAL_MIN_AVAILABLE 2     // minimum available bytes in serial buffer to start read
+#define ESTIA_SERIAL_FRAME_GAP 20        // ms of bus silence that ends a frame, bytes are 4.6 ms apart inside one
 
-#define SNIFFED_FRAMES_LIMIT 64
-
-#define REQUEST_TIMEOUT 135    // response + heartbeat transmit time
-#define REQUEST_DELAY 110      // 2x shortest valid frame transmit time
+#define REQUEST_TIMEOUT 135    // response + heartbeat transmit time, until RequestTiming has samples
+#define REQUEST_DELAY 110      // 2x shortest valid frame transmit time, upper bound of the learned spacing
 #define REQUEST_RETRIES 3
 
 #define CMD_TIMEOUT 1000
@@ -48,28 +47,24 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 
 #define ESTIA_SERIAL_TX_ECHO_MARGIN 20    // ms slack added to the expected self-echo window
 
-struct SensorData {
-	SensorData(int16_t value, const float multiplier);
-	int16_t value;
-	float multiplier;
-};
-using DataToRequest = std::deque<std::string>;
-using EstiaData = std::map<std::string, SensorData>;
-using SniffedFrames = std::deque<FrameBuffer>;
-using CommandsQueue = std::deque<EstiaFrame>;
+using RequestQueue = RingBuffer<uint8_t, 64>;    // SensorRegistry ordinals, power of two >= 2x SENSOR_REGISTRY_SIZE
+using CommandsQueue = RingBuffer<TxFrame, 16>;    // power of two >= CMD_QUEUE_SIZE
 
 class EstiaSerial {
   private:
 	int8_t rxPin;
 	int8_t txPin;
-	EstiaData sensorsData;
+	SensorRegistry sensorsData;
 	bool requestSent;
-	DataToRequest requestQueue;
+	RequestQueue requestQueue;
 	uint32_t requestTimer;
 	uint8_t requestRetry;
+	RequestTiming requestTiming;
+	BusTiming busTiming;
 	ReadBuffer snifferBuffer;
-	FrameBuffer sniffedFrame;
+	uint32_t readTimer;    // last byte received, for frame gap detection
 	SniffedFrames sniffedFrames;
+	FrameSync frameSync;
 	StatusData statusData;
 	bool cmdSent;
 	CommandsQueue cmdQueue;
@@ -85,22 +80,34 @@ class EstiaSerial {
 	uint8_t txEchoLen;
 	uint8_t txEchoIndex;
 	uint32_t txEchoDeadline;
+	bool txEchoBroken;    // mismatch mid-echo, flagged on the next captured RX frame
+
+	// single requestData(code) in flight, polled instead of waited for
+	uint8_t syncRequestCode;
+	bool syncRequestSent;
+	bool syncRequestDone;
+	uint32_t syncRequestTimer;
+	int16_t syncRequestValue;
 
-	//HardwareSerial* serial;
-	esphome::uart::UARTDevice &serial;
+	EstiaUart& serial;
+	EstiaClock& clock;
 	FrameFixer frameFixer;
+	FrameClassifier frameClassifier;
+	BusCapture* capture;    // nullptr when capture is off
 	void modeSwitch(std::string mode, uint8_t onOff);
 	void operationSwitch(std::string operation, uint8_t onOff);
-	bool splitSnifferBuffer(bool ignoreMinLen = false);
-	bool decodeStatus(FrameBuffer& buffer);
-	bool decodeAck(FrameBuffer& buffer);
-	bool decodeResponse(FrameBuffer& buffer);
-	void saveSensorData(uint16_t data);
-	void queueCommand(EstiaFrame& command);
+	void syncSnifferBuffer(bool flush = false);
+	void decodeStatus(const FrameView& frame);
+	void decodeAck(const FrameView& frame);
+	void decodeResponse(const FrameView& frame, uint8_t error);
+	void saveSensorData(uint8_t ordinal, int16_t data);
+	void saveSyncData(uint8_t ordinal, int16_t data);
+	void queueCommand(const TxFrame& command);
 	bool sendCommand();
 	bool sendRequest();
+	uint32_t requestSlot(uint8_t requestCode) const;
 	void write(const uint8_t* buffer, uint8_t len, bool disableRx = true);
-	bool read(ReadBuffer& buffer, bool byteDelay = true);
+	bool read(ReadBuffer& buffer);
 
   public:
 	enum ResponseError {
@@ -111,6 +118,7 @@ class EstiaSerial {
 		err_crc,
 		err_timeout,
 		err_not_exist,
+		err_pending,
 	};
 	enum SnifferState {
 		sniff_idle,
@@ -118,7 +126,7 @@ class EstiaSerial {
 		sniff_frame_pending,
 	};
 
-	explicit EstiaSerial(esphome::uart::UARTDevice &uart);
+	EstiaSerial(EstiaUart& uart, EstiaClock& clock);
 
 	uint16_t frameAck;
 	bool newStatusData;
@@ -126,15 +134,19 @@ class EstiaSerial {
 
 	void begin();
 	SnifferState sniffer();
-	FrameBuffer getSniffedFrame();
+	SniffedFrame getSniffedFrame();
 	uint16_t getAck();
 	StatusData& getStatusData();
-	EstiaData& getSensorsData();
+	SensorRegistry& getSensorsData();        // clears newSensorsData
+	SensorRegistry& getSensorRegistry();     // leaves it
+	const FrameFixer& getFrameFixer() const;
+	const RequestTiming& getRequestTiming() const;
+	const BusTiming& getBusTiming() const;
+	void setCapture(BusCapture* capture);
 	int16_t requestData(uint8_t requestCode);
 	int16_t requestData(std::string request);
 	void clearSensorsData();
-	bool requestSensorsData(DataToRequest&& sensorsToRequest = {SENSORS_DATA_TO_REQUEST}, bool clear = false);
-	bool requestSensorsData(DataToRequest& sensorsToRequest, bool clear = false);
+	bool requestSensorsData(const SensorList& sensorsToRequest = SensorRegistry::defaults(), bool clear = false);
 	void setOperationMode(std::string mode);
 	void setMode(std::string mode, uint8_t onOff);
 	void setTemperature(std::string zone, uint8_t temperature);
@@ -143,4 +155,5 @@ class EstiaSerial {
 	void write(const Frame& frame, bool disableRx = true);
 
 	friend class SmartTarget;
+	friend class EstiaSerialBench;
 };
@@ -0,0 +1,78 @@
+/*
+frame-builder.hpp - Estia R32 heat pump compile-time frame builder
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "frame.hpp"
+#include <array>
+
+template <size_t Len>
+using StaticFrame = std::array<uint8_t, Len>;
+
+template <size_t Len>
+using StaticPayload = std::array<uint8_t, Len - FRAME_DATA_OFFSET - FRAME_CRC_LEN>;
+
+/**
+* CRC-16/MCRF4XX usable in constant expressions.
+*
+* Bitwise on purpose: it only runs at compile time, frames built at runtime
+* pass `withCrc = false` and use the `Crc16` kernel instead.
+*/
+constexpr uint16_t crc16Constexpr(const uint8_t* data, size_t len) {
+	uint16_t crc = CRC16_INIT;
+	for (size_t idx = 0; idx < len; idx++) {
+		crc ^= data[idx];
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x0001) ? (crc >> 1) ^ CRC16_POLY_REFLECTED : crc >> 1;
+		}
+	}
+	return crc;
+}
+
+/**
+* Complete frame with header, payload and CRC as a `std::array`.
+*
+* Same layout `EstiaFrame` builds byte by byte at runtime; called from a
+* `constexpr` context the result is a constant that lives in `.rodata`.
+*/
+template <size_t Len>
+constexpr StaticFrame<Len> buildFrame(uint8_t type, uint16_t src, uint16_t dst, uint16_t dataType, const StaticPayload<Len>& payload,
+                                      bool withCrc = true) {
+	static_assert(Len >= FRAME_MIN_LEN && Len <= FRAME_MAX_LEN, "frame length out of range");
+
+	StaticFrame<Len> frame = {};
+	frame[0] = FRAME_BEGIN >> 8;
+	frame[1] = FRAME_BEGIN & 0xff;
+	frame[FRAME_TYPE_OFFSET] = type;
+	frame[FRAME_DATA_LEN_OFFSET] = Len - FRAME_HEAD_AND_CRC_LEN;
+	frame[FRAME_SRC_OFFSET] = src >> 8;
+	frame[FRAME_SRC_OFFSET + 1] = src & 0xff;
+	frame[FRAME_DST_OFFSET] = dst >> 8;
+	frame[FRAME_DST_OFFSET + 1] = dst & 0xff;
+	frame[FRAME_DATA_TYPE_OFFSET] = dataType >> 8;
+	frame[FRAME_DATA_TYPE_OFFSET + 1] = dataType & 0xff;
+	for (size_t idx = 0; idx < payload.size(); idx++) {
+		frame[FRAME_DATA_OFFSET + idx] = payload[idx];
+	}
+	if (!withCrc) { return frame; }
+
+	uint16_t crc = crc16Constexpr(frame.data(), Len - FRAME_CRC_LEN);
+	frame[Len - 2] = crc >> 8;
+	frame[Len - 1] = crc & 0xff;
+	return frame;
+}
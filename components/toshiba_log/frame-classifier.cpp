@@ -0,0 +1,55 @@
+/*
+frame-classifier.cpp - Estia R32 heat pump received frame classifier
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "frame-classifier.hpp"
+
+FrameClassifier::FrameClassifier()
+    : keys()
+    , kinds()
+    , lengths()
+    , count(0) {
+	for (auto& frame : knownFrames) {
+		if (count >= FRAME_CLASSES_MAX) { break; }
+
+		keys[count] = key(frame.frameType, frame.dataLen, frame.src, frame.dst, frame.dataType);
+		kinds[count] = frame.kind;
+		lengths[count] = frame.len;
+		count++;
+	}
+}
+
+uint64_t FrameClassifier::key(uint8_t type, uint8_t dataLen, uint16_t src, uint16_t dst, uint16_t dataType) {
+	return (uint64_t)type << 56 | (uint64_t)dataLen << 48 | (uint64_t)src << 32 | (uint64_t)dst << 16 | dataType;
+}
+
+FrameClass FrameClassifier::classify(const FrameView& frame) const {
+	return classify(frame, frame.crcValid());
+}
+
+FrameClass FrameClassifier::classify(const FrameView& frame, bool crcValid) const {
+	FrameClass frameClass = {frame_unknown, crcValid ? EstiaFrame::err_ok : EstiaFrame::err_crc};
+	if (frame.size() < FRAME_MIN_LEN || frame.readUint16(0) != FRAME_BEGIN) { return frameClass; }
+
+	uint64_t frameKey = key(frame.type(), frame.dataLength(), frame.src(), frame.dst(), frame.dataType());
+	for (uint8_t idx = 0; idx < count; idx++) {
+		if (keys[idx] != frameKey) { continue; }
+		if (lengths[idx] == frame.size()) { frameClass.kind = kinds[idx]; }
+		break;
+	}
+	return frameClass;
+}
@@ -0,0 +1,57 @@
+/*
+frame-classifier.hpp - Estia R32 heat pump received frame classifier
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "frame-fixer.hpp"
+#include "frame-view.hpp"
+
+#define FRAME_CLASSES_MAX 16
+
+struct FrameClass {
+	FrameKind kind;
+	uint8_t error;    // EstiaFrame::Error, err_ok or err_crc
+
+	bool valid() const { return error == EstiaFrame::err_ok; }
+};
+
+/**
+* One-shot classification of a received frame.
+*
+* Type, data length, source, destination and data type of a frame are
+* packed into one 64-bit key and looked up in a table built from
+* `knownFrames`. A frame that matches a known header and length has a kind,
+* everything else is `frame_unknown`. The CRC verdict is reported next to
+* the kind, so a classified `valid()` frame can go straight to the payload
+* decoder without the `is*Frame()` and `check()` passes.
+*/
+class FrameClassifier {
+  private:
+	uint64_t keys[FRAME_CLASSES_MAX];
+	FrameKind kinds[FRAME_CLASSES_MAX];
+	uint8_t lengths[FRAME_CLASSES_MAX];
+	uint8_t count;
+
+	static uint64_t key(uint8_t type, uint8_t dataLen, uint16_t src, uint16_t dst, uint16_t dataType);
+
+  public:
+	FrameClassifier();
+
+	FrameClass classify(const FrameView& frame) const;
+	FrameClass classify(const FrameView& frame, bool crcValid) const;    // CRC already checked by `FrameFixer`
+};
@@ -17,87 +17,235 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 */
 
 #include "frame-fixer.hpp"
+#include <algorithm>
+#include <array>
 
 
 KnownFrames knownFrames = {
-    KnownFrame(FRAME_TYPE_CTRL_FRAME, FRAME_HEARTBEAT_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_BROADCAST, FRAME_DATA_TYPE_HEARTBEAT),      // heartbeat
-    KnownFrame(FRAME_TYPE_STATUS2, FRAME_STATUS2_DATA_LEN, FRAME_SRC_DST_REMOTE, FRAME_SRC_DST_MASTER, FRAME_DATA_TYPE_STATUS),                 // remote status 30s
-    KnownFrame(FRAME_TYPE_STATUS, FRAME_STATUS_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_BROADCAST, FRAME_DATA_TYPE_STATUS),                // master status 30s
-    KnownFrame(FRAME_TYPE_STATUS, FRAME_SHORT_STATUS_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_BROADCAST, FRAME_DATA_TYPE_SHORT_STATUS),    // master status 30m
-    KnownFrame(FRAME_TYPE_UPDATE, FRAME_UPDATE_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_BROADCAST, FRAME_DATA_TYPE_STATUS),                // master status update
-    KnownFrame(FRAME_TYPE_RES_DATA, FRAME_RES_DATA_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_REMOTE, FRAME_DATA_TYPE_DATA_RESPONSE),        // data response
-    KnownFrame(FRAME_TYPE_ACK, FRAME_ACK_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_MASTER, FRAME_DATA_TYPE_ACK),                            // ack 1
-    KnownFrame(FRAME_TYPE_ACK, FRAME_ACK_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_REMOTE, FRAME_DATA_TYPE_ACK),                            // ack 2
+    KnownFrame(frame_heartbeat, FRAME_TYPE_CTRL_FRAME, FRAME_HEARTBEAT_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_BROADCAST, FRAME_DATA_TYPE_HEARTBEAT),      // heartbeat
+    KnownFrame(frame_remote_status, FRAME_TYPE_STATUS2, FRAME_STATUS2_DATA_LEN, FRAME_SRC_DST_REMOTE, FRAME_SRC_DST_MASTER, FRAME_DATA_TYPE_STATUS),                 // remote status 30s
+    KnownFrame(frame_status, FRAME_TYPE_STATUS, FRAME_STATUS_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_BROADCAST, FRAME_DATA_TYPE_STATUS),                // master status 30s
+    KnownFrame(frame_short_status, FRAME_TYPE_STATUS, FRAME_SHORT_STATUS_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_BROADCAST, FRAME_DATA_TYPE_SHORT_STATUS),    // master status 30m
+    KnownFrame(frame_status_update, FRAME_TYPE_UPDATE, FRAME_UPDATE_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_BROADCAST, FRAME_DATA_TYPE_STATUS),                // master status update
+    KnownFrame(frame_data_response, FRAME_TYPE_RES_DATA, FRAME_RES_DATA_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_REMOTE, FRAME_DATA_TYPE_DATA_RESPONSE),        // data response
+    KnownFrame(frame_ack, FRAME_TYPE_ACK, FRAME_ACK_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_MASTER, FRAME_DATA_TYPE_ACK),                            // ack 1
+    KnownFrame(frame_ack, FRAME_TYPE_ACK, FRAME_ACK_DATA_LEN, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_REMOTE, FRAME_DATA_TYPE_ACK),                            // ack 2
 };
 
-KnownFrame::KnownFrame(uint8_t frameType, uint8_t dataLen, uint16_t src, uint16_t dst, uint16_t dataType)
-    : frameType(frameType)
+KnownFrame::KnownFrame(FrameKind kind, uint8_t frameType, uint8_t dataLen, uint16_t src, uint16_t dst, uint16_t dataType)
+    : kind(kind)
+    , frameType(frameType)
     , dataLen(dataLen)
     , src(src)
     , dst(dst)
     , dataType(dataType)
     , len(dataLen + FRAME_HEAD_AND_CRC_LEN) {}
 
+// single bit flip syndromes, position counted in bytes from the frame end
+// (0 and 1 are the CRC itself), sorted by syndrome for a binary search
+struct BitSyndrome {
+	uint16_t syndrome;
+	uint8_t fromEnd;
+	uint8_t mask;
+};
+
+#define SYNDROME_TABLE_SIZE (FRAME_MAX_LEN * 8)
+
+static constexpr uint16_t zeroCrcStep(uint16_t crc) {
+	for (uint8_t bit = 0; bit < 8; bit++) {
+		crc = crc & 0x0001 ? (crc >> 1) ^ CRC16_POLY_REFLECTED : crc >> 1;
+	}
+	return crc;
+}
+
+static constexpr std::array<BitSyndrome, SYNDROME_TABLE_SIZE> makeSyndromeTable() {
+	std::array<BitSyndrome, SYNDROME_TABLE_SIZE> table = {};
+	size_t count = 0;
+	for (uint8_t bit = 0; bit < 8; bit++) {
+		uint8_t mask = 1 << bit;
+		// CRC is stored big endian: last byte is the low half
+		table[count++] = {static_cast<uint16_t>(mask), 0, mask};
+		table[count++] = {static_cast<uint16_t>(mask << 8), 1, mask};
+		// data bit: CRC with zero init over the flipped bit and the bytes after it
+		uint16_t syndrome = zeroCrcStep(mask);
+		for (uint8_t fromEnd = FRAME_CRC_LEN; fromEnd < FRAME_MAX_LEN; fromEnd++) {
+			table[count++] = {syndrome, fromEnd, mask};
+			syndrome = zeroCrcStep(syndrome);
+		}
+	}
+	for (size_t idx = 1; idx < table.size(); idx++) {
+		BitSyndrome entry = table[idx];
+		size_t pos = idx;
+		for (; pos > 0 && table[pos - 1].syndrome > entry.syndrome; pos--) {
+			table[pos] = table[pos - 1];
+		}
+		table[pos] = entry;
+	}
+	return table;
+}
+
+static constexpr std::array<BitSyndrome, SYNDROME_TABLE_SIZE> syndromeTable = makeSyndromeTable();
+
+static constexpr bool syndromesUnique() {
+	for (size_t idx = 1; idx < syndromeTable.size(); idx++) {
+		if (syndromeTable[idx - 1].syndrome == syndromeTable[idx].syndrome) { return false; }
+	}
+	return true;
+}
+static_assert(syndromesUnique(), "single bit errors must map to distinct syndromes");
+
 FrameFixer::FrameFixer()
-    : fixedBuffer()
-    , crc() {
+    : receivedBuffer()
+    , fixedBuffer()
+    , crc()
+    , strategies()
+    , order()
+    , recovered()
+    , unrecovered(0)
+    , repairs(0)
+    , crcChecks(0)
+    , lastMethod(fix_methods) {
+	receivedBuffer.reserve(FRAME_MAX_LEN);
 	fixedBuffer.reserve(FRAME_MAX_LEN);
+	strategies.push_back({fix_missing_bytes, FIXER_ANY_FRAME, 0, 0});
+	strategies.push_back({fix_data_length, FIXER_ANY_FRAME, 0, 0});
+	strategies.push_back({fix_static_bytes, FIXER_ANY_FRAME, 0, 0});
+	for (uint8_t idx = 0; idx < knownFrames.size(); idx++) {
+		strategies.push_back({fix_frame_type, idx, 0, 0});
+		strategies.push_back({fix_data_header, idx, 0, 0});
+	}
+	for (uint8_t idx = 0; idx < strategies.size(); idx++) {
+		order.push_back(idx);
+	}
 }
 
 bool FrameFixer::fixFrame(FrameBuffer& buffer) {
+	this->lastMethod = fix_methods;
 	if (buffer.size() < FRAME_MIN_LEN - 2) { return false; }
 
 	this->crc = EstiaFrame::readUint16(buffer, buffer.size() - 2);
-	if (crc == EstiaFrame::crc16(buffer.data(), buffer.size() - 2)) { return true; }
+	uint16_t computed = EstiaFrame::crc16(buffer.data(), buffer.size() - 2);
+	if (crc == computed) { return true; }
 
-	this->fixedBuffer = buffer;
-
-	if (this->addMissingBytes()) {
-		buffer.swap(fixedBuffer);
+	if (this->fixSingleBit(buffer, computed ^ crc)) {
+		recovered[fix_syndrome]++;
+		this->lastMethod = fix_syndrome;
 		return true;
 	}
 
-	if (fixedBuffer.size() < FRAME_MIN_LEN) { return false; }
-
-	if (this->fixDataLength()) {
-		buffer.swap(fixedBuffer);
-		return true;
+	// every strategy starts from the received frame, padded when it lost its
+	// leading bytes
+	this->receivedBuffer = buffer;
+	bool padded = this->padMissingBytes();
+	if (receivedBuffer.size() < FRAME_MIN_LEN) {
+		unrecovered++;
+		return false;
 	}
 
-	if (this->fixStaticBytes()) {
+	this->fixedBuffer = receivedBuffer;
+	bool explore = ++repairs % FIXER_EXPLORE_INTERVAL == 0;
+	for (uint8_t rank = 0; rank < order.size(); rank++) {
+		uint8_t idx = explore ? rank : order[rank];
+		if (!this->attempt(strategies[idx], padded)) { continue; }
+
+		recovered[strategies[idx].method]++;
+		this->lastMethod = strategies[idx].method;
+		strategies[idx].hits++;
+		this->scoreHit(std::find(order.begin(), order.end(), idx) - order.begin());
 		buffer.swap(fixedBuffer);
 		return true;
 	}
 
-	// fix frame specific bytes
-	for (auto& frame : knownFrames) {
-		if (fixedBuffer.at(FRAME_DATA_LEN_OFFSET) != frame.dataLen) { continue; }
+	unrecovered++;
+	return false;
+};
 
-		if (this->fixFrameType(frame)) {
-			buffer.swap(fixedBuffer);
-			return true;
+// move a successful strategy ahead of the ones with a lower score
+void FrameFixer::scoreHit(uint8_t rank) {
+	FixStrategy& hit = strategies[order[rank]];
+	if (++hit.score >= FIXER_SCORE_MAX) {
+		for (auto& strategy : strategies) {
+			strategy.score /= 2;
 		}
-		if (this->fixDataHeader(frame)) {
-			buffer.swap(fixedBuffer);
+	}
+	for (; rank > 0 && strategies[order[rank - 1]].score < hit.score; rank--) {
+		std::swap(order[rank - 1], order[rank]);
+	}
+}
+
+bool FrameFixer::attempt(const FixStrategy& strategy, bool padded) {
+	switch (strategy.method) {
+		case fix_missing_bytes: return padded && this->crcMatches();
+		case fix_data_length: return this->fixDataLength();
+		case fix_static_bytes: return this->fixStaticBytes();
+		case fix_frame_type: return this->fixFrameType(knownFrames[strategy.frame]);
+		case fix_data_header: return this->fixDataHeader(knownFrames[strategy.frame]);
+		default: return false;
+	}
+}
+
+// strategies only touch the buffer right before checking it, a failed one
+// is undone here for the next
+bool FrameFixer::crcMatches() {
+	crcChecks++;
+	if (crc == EstiaFrame::crc16(fixedBuffer.data(), fixedBuffer.size() - 2)) { return true; }
+
+	this->fixedBuffer = receivedBuffer;
+	return false;
+}
+
+const char* FrameFixer::methodName(FixMethod method) {
+	switch (method) {
+		case fix_syndrome: return "syndrome";
+		case fix_missing_bytes: return "missing bytes";
+		case fix_data_length: return "data length";
+		case fix_static_bytes: return "static bytes";
+		case fix_frame_type: return "frame type";
+		case fix_data_header: return "data header";
+		default: return "";
+	}
+}
+
+bool FrameFixer::fixSingleBit(FrameBuffer& buffer, uint16_t syndrome) {
+	auto entry = std::lower_bound(syndromeTable.begin(), syndromeTable.end(), syndrome,
+	                              [](const BitSyndrome& lhs, uint16_t rhs) { return lhs.syndrome < rhs; });
+	if (entry == syndromeTable.end() || entry->syndrome != syndrome) { return false; }
+	if (entry->fromEnd >= buffer.size()) { return false; }
+
+	// several errors can add up to a single bit's syndrome, a correction that
+	// doesn't leave a known frame is one of those
+	uint8_t& damaged = buffer.at(buffer.size() - 1 - entry->fromEnd);
+	damaged ^= entry->mask;
+	if (knownHeader(buffer)) { return true; }
+
+	damaged ^= entry->mask;
+	return false;
+}
+
+bool FrameFixer::knownHeader(const FrameBuffer& buffer) {
+	if (buffer.size() < FRAME_MIN_LEN || EstiaFrame::readUint16(buffer, 0) != FRAME_BEGIN) { return false; }
+
+	for (const KnownFrame& frame : knownFrames) {
+		if (buffer.size() == frame.len && buffer.at(FRAME_TYPE_OFFSET) == frame.frameType
+		    && buffer.at(FRAME_DATA_LEN_OFFSET) == frame.dataLen && EstiaFrame::readUint16(buffer, FRAME_SRC_OFFSET) == frame.src
+		    && EstiaFrame::readUint16(buffer, FRAME_DST_OFFSET) == frame.dst
+		    && EstiaFrame::readUint16(buffer, FRAME_DATA_TYPE_OFFSET) == frame.dataType) {
 			return true;
 		}
 	}
-
 	return false;
-};
+}
 
-bool FrameFixer::addMissingBytes() {
-	if (EstiaFrame::readUint16(fixedBuffer, 0) == FRAME_BEGIN) { return false; }
+bool FrameFixer::padMissingBytes() {
+	if (EstiaFrame::readUint16(receivedBuffer, 0) == FRAME_BEGIN) { return false; }
 
 	for (auto& frame : knownFrames) {
-		if (fixedBuffer.front() == 0x00 && fixedBuffer.size() == frame.len - 1) {
-			fixedBuffer.insert(fixedBuffer.begin(), 0xa0);
-			if (crc == EstiaFrame::crc16(fixedBuffer.data(), fixedBuffer.size() - 2)) { return true; }
-			break;
-		} else if (fixedBuffer.front() == frame.frameType && fixedBuffer.size() == frame.len - 2) {
-			fixedBuffer.insert(fixedBuffer.begin(), {0xa0, 0x00});
-			if (crc == EstiaFrame::crc16(fixedBuffer.data(), fixedBuffer.size() - 2)) { return true; }
-			break;
+		if (receivedBuffer.front() == 0x00 && receivedBuffer.size() + 1 == frame.len) {
+			receivedBuffer.insert(receivedBuffer.begin(), 0xa0);
+			return true;
+		} else if (receivedBuffer.front() == frame.frameType && receivedBuffer.size() + 2 == frame.len) {
+			receivedBuffer.insert(receivedBuffer.begin(), {0xa0, 0x00});
+			return true;
 		}
 	}
 	return false;
@@ -107,29 +255,52 @@ bool FrameFixer::fixDataLength() {
 	if (fixedBuffer.at(FRAME_DATA_LEN_OFFSET) + FRAME_HEAD_AND_CRC_LEN == fixedBuffer.size()) { return false; }
 
 	fixedBuffer.at(FRAME_DATA_LEN_OFFSET) = fixedBuffer.size() - FRAME_HEAD_AND_CRC_LEN;
-	if (crc == EstiaFrame::crc16(fixedBuffer.data(), fixedBuffer.size() - 2)) { return true; }
-	return false;
+	return this->crcMatches();
 }
 
 bool FrameFixer::fixStaticBytes() {
+	if (EstiaFrame::readUint16(fixedBuffer, 0) == FRAME_BEGIN) { return false; }
+
 	EstiaFrame::writeUint16(fixedBuffer, 0, FRAME_BEGIN);
-	fixedBuffer.at(FRAME_DATA_HEADER_OFFSET) == 0x00;
-	if (crc == EstiaFrame::crc16(fixedBuffer.data(), fixedBuffer.size() - 2)) { return true; }
-	return false;
+	fixedBuffer.at(FRAME_DATA_HEADER_OFFSET) = 0x00;
+	return this->crcMatches();
 }
 
+// strategies run independently, so the known frame fixes also restore the
+// static bytes and data length an earlier fix used to leave behind
 bool FrameFixer::fixFrameType(const KnownFrame& frame) {
+	if (fixedBuffer.size() != frame.len) { return false; }
 	if (fixedBuffer.at(FRAME_TYPE_OFFSET) == frame.frameType) { return false; }
 
-	fixedBuffer.at(FRAME_TYPE_OFFSET) = frame.frameType;
-	if (crc == EstiaFrame::crc16(fixedBuffer.data(), fixedBuffer.size() - 2)) { return true; }
-	return false;
+	this->writeWord(0, FRAME_BEGIN);
+	this->writeByte(FRAME_DATA_LEN_OFFSET, frame.dataLen);
+	this->writeByte(FRAME_TYPE_OFFSET, frame.frameType);
+	return this->crcMatches();
 }
 
 bool FrameFixer::fixDataHeader(const KnownFrame& frame) {
-	EstiaFrame::writeUint16(fixedBuffer, FRAME_SRC_OFFSET, frame.src);
-	EstiaFrame::writeUint16(fixedBuffer, FRAME_DST_OFFSET, frame.dst);
-	EstiaFrame::writeUint16(fixedBuffer, FRAME_DATA_TYPE_OFFSET, frame.dataType);
-	if (crc == EstiaFrame::crc16(fixedBuffer.data(), fixedBuffer.size() - 2)) { return true; }
-	return false;
+	if (fixedBuffer.size() != frame.len) { return false; }
+
+	bool changed = this->writeWord(0, FRAME_BEGIN);
+	changed |= this->writeByte(FRAME_DATA_LEN_OFFSET, frame.dataLen);
+	changed |= this->writeByte(FRAME_TYPE_OFFSET, frame.frameType);
+	changed |= this->writeWord(FRAME_SRC_OFFSET, frame.src);
+	changed |= this->writeWord(FRAME_DST_OFFSET, frame.dst);
+	changed |= this->writeWord(FRAME_DATA_TYPE_OFFSET, frame.dataType);
+	if (!changed) { return false; }
+	return this->crcMatches();
+}
+
+bool FrameFixer::writeByte(uint8_t offset, uint8_t value) {
+	if (fixedBuffer.at(offset) == value) { return false; }
+
+	fixedBuffer.at(offset) = value;
+	return true;
+}
+
+bool FrameFixer::writeWord(uint8_t offset, uint16_t value) {
+	if (EstiaFrame::readUint16(fixedBuffer, offset) == value) { return false; }
+
+	EstiaFrame::writeUint16(fixedBuffer, offset, value);
+	return true;
 }
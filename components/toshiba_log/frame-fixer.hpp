@@ -21,9 +21,22 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 #include "frame.hpp"
 #include <vector>
 
+// what a received frame is once its header matched a known frame
+enum FrameKind : uint8_t {
+	frame_unknown,
+	frame_heartbeat,
+	frame_remote_status,
+	frame_status,
+	frame_short_status,
+	frame_status_update,
+	frame_data_response,
+	frame_ack,
+};
+
 struct KnownFrame {
-	KnownFrame(uint8_t frameType, uint8_t dataLen, uint16_t src, uint16_t dst, uint16_t dataType);
+	KnownFrame(FrameKind kind, uint8_t frameType, uint8_t dataLen, uint16_t src, uint16_t dst, uint16_t dataType);
 
+	FrameKind kind;
 	uint8_t frameType;
 	uint8_t dataLen;
 	uint16_t src;
@@ -34,19 +47,82 @@ struct KnownFrame {
 
 using KnownFrames = std::vector<KnownFrame>;
 
+extern KnownFrames knownFrames;
+
+#define FIXER_EXPLORE_INTERVAL 16    // every Nth repair walks the declared order
+#define FIXER_SCORE_MAX 1024          // scores are halved when one reaches this
+#define FIXER_ANY_FRAME 0xff
+
+/**
+* Repairs sniffed frames that fail the CRC check.
+*
+* CRC-16/MCRF4XX is linear, so the syndrome (computed CRC xor received CRC)
+* of a single flipped bit depends only on how far from the end of the frame
+* the bit is. A flip anywhere in the frame, CRC included, is corrected with
+* one CRC and a lookup in a table shared by all frame lengths. Several
+* errors can produce the same syndrome, so a correction only stands when it
+* leaves the header and length of a known frame.
+*
+* Frames with lost bytes or several damaged header bytes fall back to
+* strategies that rewrite static and known header fields, each checked with
+* one more CRC. Strategies are independent of each other and tried in order
+* of their recent success, so the repair that is common on this bus costs a
+* single CRC. Every `FIXER_EXPLORE_INTERVAL`th repair uses the declared order
+* instead, letting strategies shadowed by a popular one keep scoring.
+*/
 class FrameFixer {
+  public:
+	enum FixMethod {
+		fix_syndrome,
+		fix_missing_bytes,
+		fix_data_length,
+		fix_static_bytes,
+		fix_frame_type,
+		fix_data_header,
+		fix_methods,
+	};
+
+	struct FixStrategy {
+		FixMethod method;
+		uint8_t frame;    // `knownFrames` index, `FIXER_ANY_FRAME` for generic fixes
+		uint32_t hits;
+		uint16_t score;    // aged hits, decides the order
+	};
+
   private:
-	bool addMissingBytes();
+	bool fixSingleBit(FrameBuffer& buffer, uint16_t syndrome);
+	static bool knownHeader(const FrameBuffer& buffer);    // header and length of a `knownFrames` entry
+	bool padMissingBytes();
+	bool crcMatches();
+	bool attempt(const FixStrategy& strategy, bool padded);
 	bool fixDataLength();
 	bool fixStaticBytes();
 	bool fixFrameType(const KnownFrame& frame);
 	bool fixDataHeader(const KnownFrame& frame);
+	bool writeByte(uint8_t offset, uint8_t value);    // false if already set
+	bool writeWord(uint8_t offset, uint16_t value);
+	void scoreHit(uint8_t rank);
 
+	FrameBuffer receivedBuffer;
 	FrameBuffer fixedBuffer;
 	uint16_t crc;
+	std::vector<FixStrategy> strategies;
+	std::vector<uint8_t> order;
+	uint32_t recovered[fix_methods];
+	uint32_t unrecovered;
+	uint32_t repairs;
+	uint32_t crcChecks;
+	FixMethod lastMethod;
 
   public:
 	FrameFixer();
 
 	bool fixFrame(FrameBuffer& buffer);
+	uint32_t recoveredCount(FixMethod method) const { return recovered[method]; }
+	uint32_t unrecoveredCount() const { return unrecovered; }
+	FixMethod lastFix() const { return lastMethod; }    // repair of the last `fixFrame()`, `fix_methods` if none
+	uint32_t crcCheckCount() const { return crcChecks; }    // CRCs computed by the fallback strategies
+	uint8_t strategyCount() const { return strategies.size(); }
+	const FixStrategy& strategy(uint8_t rank) const { return strategies[order[rank]]; }    // by current order
+	static const char* methodName(FixMethod method);
 };
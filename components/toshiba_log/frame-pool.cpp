@@ -0,0 +1,208 @@
+/*
+frame-pool.cpp - Estia R32 heat pump pooled sniffed frame storage
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "frame-pool.hpp"
+#include <utility>
+
+#define FRAME_PRIORITY_HEARTBEAT 0
+#define FRAME_PRIORITY_OTHER 1
+#define FRAME_PRIORITY_DATA 2
+
+FramePool::FramePool()
+    : slots()
+    , classes()
+    , freeSlots()
+    , freeCount(FRAME_POOL_SLOTS) {
+	for (uint8_t slot = 0; slot < FRAME_POOL_SLOTS; slot++) {
+		slots[slot].reserve(FRAME_SLOT_SIZE);
+		freeSlots[slot] = slot;
+	}
+}
+
+uint8_t FramePool::acquire() {
+	if (freeCount == 0) { return FRAME_SLOT_NONE; }
+	return freeSlots[--freeCount];
+}
+
+void FramePool::release(uint8_t slot) {
+	if (slot >= FRAME_POOL_SLOTS || freeCount >= FRAME_POOL_SLOTS) { return; }
+	slots[slot].clear();
+	classes[slot] = {frame_unknown, EstiaFrame::err_ok};
+	freeSlots[freeCount++] = slot;
+}
+
+FrameBuffer& FramePool::at(uint8_t slot) {
+	return slots[slot];
+}
+
+FrameClass& FramePool::classAt(uint8_t slot) {
+	return classes[slot];
+}
+
+uint8_t FramePool::available() const {
+	return freeCount;
+}
+
+SniffedFrame::SniffedFrame()
+    : pool(nullptr)
+    , slot(FRAME_SLOT_NONE) {
+}
+
+SniffedFrame::SniffedFrame(FramePool& pool, uint8_t slot)
+    : pool(&pool)
+    , slot(slot) {
+}
+
+SniffedFrame::SniffedFrame(SniffedFrame&& other)
+    : pool(other.pool)
+    , slot(other.slot) {
+	other.pool = nullptr;
+	other.slot = FRAME_SLOT_NONE;
+}
+
+SniffedFrame& SniffedFrame::operator=(SniffedFrame&& other) {
+	if (this != &other) {
+		if (pool) { pool->release(slot); }
+		pool = other.pool;
+		slot = other.slot;
+		other.pool = nullptr;
+		other.slot = FRAME_SLOT_NONE;
+	}
+	return *this;
+}
+
+SniffedFrame::~SniffedFrame() {
+	if (pool) { pool->release(slot); }
+}
+
+bool SniffedFrame::empty() const {
+	return pool == nullptr || pool->at(slot).empty();
+}
+
+const FrameBuffer& SniffedFrame::operator*() const {
+	static const FrameBuffer none;
+	return pool ? pool->at(slot) : none;
+}
+
+const FrameBuffer* SniffedFrame::operator->() const {
+	return &**this;
+}
+
+FrameClass SniffedFrame::frameClass() const {
+	return pool ? pool->classAt(slot) : FrameClass{frame_unknown, EstiaFrame::err_ok};
+}
+
+SniffedFrames::SniffedFrames()
+    : pool()
+    , queue()
+    , undecoded(0)
+    , evictions(0) {
+}
+
+uint8_t SniffedFrames::priority(const FrameBuffer& frame) {
+	if (frame.size() < FRAME_HEAD_LEN || EstiaFrame::readUint16(frame, 0) != FRAME_BEGIN) { return FRAME_PRIORITY_OTHER; }
+
+	switch (frame.at(FRAME_TYPE_OFFSET)) {
+	case FRAME_TYPE_CTRL_FRAME:
+		return EstiaFrame::readUint16(frame, FRAME_DATA_TYPE_OFFSET) == FRAME_DATA_TYPE_HEARTBEAT ? FRAME_PRIORITY_HEARTBEAT : FRAME_PRIORITY_OTHER;
+
+	case FRAME_TYPE_STATUS:
+	case FRAME_TYPE_STATUS2:
+	case FRAME_TYPE_UPDATE:
+	case FRAME_TYPE_ACK:
+	case FRAME_TYPE_RES_DATA:
+		return FRAME_PRIORITY_DATA;
+
+	default:
+		return FRAME_PRIORITY_OTHER;
+	}
+}
+
+// drop the oldest frame of the lowest priority
+bool SniffedFrames::evict() {
+	if (queue.empty()) { return false; }
+
+	size_t victim = 0;
+	uint8_t victimPriority = FRAME_PRIORITY_DATA + 1;
+	for (size_t idx = 0; idx < queue.size(); idx++) {
+		uint8_t framePriority = priority(pool.at(queue.at(idx)));
+		if (framePriority < victimPriority) {
+			victim = idx;
+			victimPriority = framePriority;
+			if (framePriority == FRAME_PRIORITY_HEARTBEAT) { break; }
+		}
+	}
+	if (victim >= queue.size() - undecoded) { undecoded--; }
+	pool.release(queue.at(victim));
+	queue.erase(victim);
+	evictions++;
+	return true;
+}
+
+bool SniffedFrames::push(const uint8_t* data, uint8_t len) {
+	if (queue.full() || pool.available() == 0) { evict(); }
+	uint8_t slot = pool.acquire();
+	if (slot == FRAME_SLOT_NONE) { return false; }    // every slot held by consumers
+
+	pool.at(slot).assign(data, data + len);
+	queue.push_back(slot);
+	undecoded++;
+	return true;
+}
+
+// oldest frame not handed out for decoding yet, nullptr when caught up
+FrameBuffer* SniffedFrames::nextUndecoded(FrameClass** frameClass) {
+	if (undecoded == 0) { return nullptr; }
+	size_t idx = queue.size() - undecoded;
+	undecoded--;
+	if (frameClass) { *frameClass = &pool.classAt(queue.at(idx)); }
+	return &pool.at(queue.at(idx));
+}
+
+SniffedFrame SniffedFrames::pop() {
+	if (queue.empty()) { return SniffedFrame(); }
+
+	uint8_t slot = queue.front();
+	queue.pop_front();
+	if (undecoded > queue.size()) { undecoded--; }
+	return SniffedFrame(pool, slot);
+}
+
+FrameBuffer& SniffedFrames::front() {
+	return pool.at(queue.front());
+}
+
+void SniffedFrames::clear() {
+	while (!queue.empty()) {
+		pool.release(queue.front());
+		queue.pop_front();
+	}
+	undecoded = 0;
+}
+
+size_t SniffedFrames::size() const {
+	return queue.size();
+}
+
+bool SniffedFrames::empty() const {
+	return queue.empty();
+}
+
+uint32_t SniffedFrames::evictedCount() const {
+	return evictions;
+}
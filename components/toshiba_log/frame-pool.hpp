@@ -0,0 +1,112 @@
+/*
+frame-pool.hpp - Estia R32 heat pump pooled sniffed frame storage
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "frame-classifier.hpp"
+#include "frame.hpp"
+#include "ring-buffer.hpp"
+
+#define SNIFFED_FRAMES_LIMIT 64    // queued frames, power of two
+#define FRAME_POOL_SLOTS (SNIFFED_FRAMES_LIMIT + 4)    // queue plus frames held by consumers
+#define FRAME_SLOT_SIZE (FRAME_MAX_LEN + 2)    // FrameFixer may restore 2 missing head bytes
+#define FRAME_SLOT_NONE 0xff
+
+static_assert(FRAME_POOL_SLOTS < FRAME_SLOT_NONE, "frame pool slot index must fit uint8_t");
+
+/**
+* Frame buffers preallocated once with `FRAME_SLOT_SIZE` capacity.
+*
+* Slots are plain `FrameBuffer`s so `FrameFixer` and the decoders work on
+* them unchanged, the capacity is never exceeded so they never reallocate.
+* Each slot also keeps the classification of its frame.
+*/
+class FramePool {
+  private:
+	FrameBuffer slots[FRAME_POOL_SLOTS];
+	FrameClass classes[FRAME_POOL_SLOTS];
+	uint8_t freeSlots[FRAME_POOL_SLOTS];
+	uint8_t freeCount;
+
+  public:
+	FramePool();
+	FramePool(const FramePool&) = delete;
+	FramePool& operator=(const FramePool&) = delete;
+
+	uint8_t acquire();    // FRAME_SLOT_NONE when exhausted
+	void release(uint8_t slot);
+	FrameBuffer& at(uint8_t slot);
+	FrameClass& classAt(uint8_t slot);
+	uint8_t available() const;
+};
+
+/**
+* Move-only handle to a pooled frame, returns the slot on destruction.
+*
+* Must not outlive the `EstiaSerial` it came from.
+*/
+class SniffedFrame {
+  private:
+	FramePool* pool;
+	uint8_t slot;
+
+  public:
+	SniffedFrame();
+	SniffedFrame(FramePool& pool, uint8_t slot);
+	SniffedFrame(SniffedFrame&& other);
+	SniffedFrame& operator=(SniffedFrame&& other);
+	SniffedFrame(const SniffedFrame&) = delete;
+	SniffedFrame& operator=(const SniffedFrame&) = delete;
+	~SniffedFrame();
+
+	bool empty() const;
+	const FrameBuffer& operator*() const;
+	const FrameBuffer* operator->() const;
+	FrameClass frameClass() const;    // as decoded by the sniffer
+};
+
+/**
+* Bounded FIFO of pooled frames between the synchronizer and consumers.
+*
+* When the queue or the pool is full the oldest frame of the lowest
+* priority is evicted: heartbeats first, then fragments and other frames,
+* status, ack and data response frames last. Frames pushed since the last
+* `nextUndecoded()` pass are tracked so decoding keeps up with evictions.
+*/
+class SniffedFrames {
+  private:
+	FramePool pool;
+	RingBuffer<uint8_t, SNIFFED_FRAMES_LIMIT> queue;
+	uint8_t undecoded;
+	uint32_t evictions;
+
+	static uint8_t priority(const FrameBuffer& frame);
+	bool evict();
+
+  public:
+	SniffedFrames();
+
+	bool push(const uint8_t* data, uint8_t len);
+	FrameBuffer* nextUndecoded(FrameClass** frameClass = nullptr);
+	SniffedFrame pop();
+	FrameBuffer& front();
+	void clear();
+	size_t size() const;
+	bool empty() const;
+	uint32_t evictedCount() const;
+};
@@ -0,0 +1,163 @@
+/*
+frame-sync.cpp - Estia R32 heat pump streaming frame synchronizer
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "frame-sync.hpp"
+#include <string.h>
+
+#define FRAME_BEGIN_HIGH 0xa0
+#define FRAME_BEGIN_LOW 0x00
+
+FrameSync::FrameSync(SniffedFrames& frames)
+    : frames(frames)
+    , state(sync_hunt)
+    , buffer()
+    , length(0)
+    , expectedLength(0)
+    , lengthMask(0)
+    , resyncOffset(0)
+    , crc() {
+}
+
+void FrameSync::push(uint8_t byte) {
+	buffer[length++] = byte;
+	bool begin = length >= 2 && byte == FRAME_BEGIN_LOW && buffer[length - 2] == FRAME_BEGIN_HIGH;
+
+	switch (state) {
+	case sync_hunt:
+		if (begin) {
+			if (length > 2) { emit(length - 2); }    // bytes before FRAME_BEGIN are a fragment
+			restart(true);
+		} else if (length >= FRAME_MAX_LEN) {
+			emit(length);
+			restart(false);
+		}
+		break;
+
+	case sync_header:
+		if (begin && length > 2) {    // a0 00 a0 00: resync on the later one
+			resyncOffset = length - 2;
+		}
+		if (length > FRAME_DATA_LEN_OFFSET) { header(); }
+		break;
+
+	case sync_payload:
+		if (expectedLength != 0) {
+			if (begin && resyncOffset == 0) { resyncOffset = length - 2; }
+			if (length >= expectedLength) { finish(); }
+			break;
+		}
+		crc.update(byte);
+		if (begin) {
+			emit(length - 2);
+			restart(true);
+		} else if (((lengthMask >> length) & 1) && crc.valid()) {
+			emit(length);
+			restart(false);
+		} else if (length >= FRAME_MAX_LEN) {
+			emit(length);
+			restart(false);
+		}
+		break;
+	}
+}
+
+void FrameSync::header() {
+	uint8_t type = buffer[FRAME_TYPE_OFFSET];
+	uint8_t dataLen = buffer[FRAME_DATA_LEN_OFFSET];
+	bool knownType = false;
+	bool knownLength = false;
+	uint64_t typeMask = 0;
+	uint64_t allMask = 0;
+	for (auto& frame : knownFrames) {
+		allMask |= 1ULL << frame.len;
+		if (frame.frameType != type) { continue; }
+		knownType = true;
+		typeMask |= 1ULL << frame.len;
+		if (frame.dataLen == dataLen) { knownLength = true; }
+	}
+	bool plausible = dataLen >= FRAME_MIN_DATA_LEN && dataLen + FRAME_HEAD_AND_CRC_LEN <= FRAME_MAX_LEN;
+
+	if (knownLength || (!knownType && plausible)) {
+		// known frame, or unknown type (commands, requests) with sane length
+		expectedLength = dataLen + FRAME_HEAD_AND_CRC_LEN;
+	} else {
+		// length byte doesn't fit the frame type, end on CRC at a known length
+		expectedLength = 0;
+		lengthMask = knownType ? typeMask : allMask;
+		for (uint8_t idx = 0; idx < length; idx++) {
+			crc.update(buffer[idx]);
+		}
+	}
+	state = sync_payload;
+	if (resyncOffset != 0 && expectedLength == 0) { resync(); }
+}
+
+void FrameSync::finish() {
+	uint16_t frameCrc = (buffer[length - 2] << 8) | buffer[length - 1];
+	if (resyncOffset == 0 || frameCrc == EstiaFrame::crc16(buffer, length - 2)) {
+		emit(length);
+		restart(false);
+		return;
+	}
+	// bad CRC with a FRAME_BEGIN inside: truncated frame ran into the next one
+	resync();
+}
+
+// emit the head as is and re-run the rest from the remembered FRAME_BEGIN
+void FrameSync::resync() {
+	uint8_t replay[FRAME_MAX_LEN];
+	uint8_t replayLen = length - resyncOffset;
+	memcpy(replay, buffer + resyncOffset, replayLen);
+	emit(resyncOffset);
+	restart(false);
+	for (uint8_t idx = 0; idx < replayLen; idx++) {
+		push(replay[idx]);
+	}
+}
+
+void FrameSync::emit(uint8_t len) {
+	if (len == 0) { return; }
+	frames.push(buffer, len);
+}
+
+void FrameSync::restart(bool withBegin) {
+	length = 0;
+	expectedLength = 0;
+	lengthMask = 0;
+	resyncOffset = 0;
+	crc.reset();
+	state = sync_hunt;
+	if (withBegin) {
+		buffer[length++] = FRAME_BEGIN_HIGH;
+		buffer[length++] = FRAME_BEGIN_LOW;
+		state = sync_header;
+	}
+}
+
+void FrameSync::flush() {
+	emit(length);
+	restart(false);
+}
+
+void FrameSync::reset() {
+	restart(false);
+}
+
+bool FrameSync::pending() const {
+	return length > 0;
+}
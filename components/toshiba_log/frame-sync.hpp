@@ -0,0 +1,71 @@
+/*
+frame-sync.hpp - Estia R32 heat pump streaming frame synchronizer
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "frame-fixer.hpp"
+#include "frame-pool.hpp"
+#include "frame.hpp"
+
+/**
+* Byte-at-a-time frame delimiter for the sniffed bus stream.
+*
+* hunt -> header -> payload: bytes not starting with `FRAME_BEGIN` are
+* collected as a fragment until the next `FRAME_BEGIN`, a frame's end is
+* predicted from its data length byte (checked against `knownFrames`) and
+* the frame is emitted the instant its last byte arrives. Each byte costs
+* O(1): the first `FRAME_BEGIN` seen inside a frame is remembered, so a
+* frame that fails its CRC can be split there (truncated frame followed by
+* the next one) without rescanning.
+*
+* Frames with an implausible length byte run a `FrameCrc` alongside and are
+* closed when it matches at a known frame length, at the next `FRAME_BEGIN`, or at `FRAME_MAX_LEN`.
+* Malformed frames and fragments are still emitted so `FrameFixer` and the
+* raw dump see them.
+*/
+class FrameSync {
+  private:
+	enum State {
+		sync_hunt,
+		sync_header,
+		sync_payload,
+	};
+
+	SniffedFrames& frames;
+	State state;
+	uint8_t buffer[FRAME_MAX_LEN];
+	uint8_t length;
+	uint8_t expectedLength;    // 0 when the length byte is not trusted
+	uint64_t lengthMask;       // bit n set: n is a known frame length for this frame type
+	uint8_t resyncOffset;      // first FRAME_BEGIN after offset 0, 0 if none
+	FrameCrc crc;              // only fed while expectedLength is 0
+
+	void restart(bool withBegin);
+	void emit(uint8_t len);
+	void header();
+	void finish();
+	void resync();
+
+  public:
+	FrameSync(SniffedFrames& frames);
+
+	void push(uint8_t byte);
+	void flush();    // emit whatever is pending (read timeout)
+	void reset();
+	bool pending() const;
+};
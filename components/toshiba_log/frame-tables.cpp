@@ -0,0 +1,166 @@
+/*
+frame-tables.cpp - Estia R32 heat pump precomputed TX frames
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "frame-tables.hpp"
+#include "sensor-registry.hpp"
+#include <string.h>
+
+constexpr uint8_t requestCodes[] = {REQUEST_CODES};
+constexpr size_t requestCount = sizeof(requestCodes);
+static_assert(requestCount == SENSOR_REGISTRY_SIZE, "request frames indexed by SensorRegistry ordinal");
+
+constexpr StaticFrame<FRAME_REQ_DATA_LEN> makeRequest(uint8_t code) {
+	StaticPayload<FRAME_REQ_DATA_LEN> payload = {REQ_DATA_BASE};
+	payload[REQ_DATA_CODE_OFFSET - FRAME_DATA_OFFSET] = code;
+	return buildFrame<FRAME_REQ_DATA_LEN>(FRAME_TYPE_REQ_DATA, REQ_DATA_SRC, REQ_DATA_DST, FRAME_DATA_TYPE_DATA_REQUEST, payload);
+}
+
+constexpr std::array<StaticFrame<FRAME_REQ_DATA_LEN>, requestCount> makeRequests() {
+	std::array<StaticFrame<FRAME_REQ_DATA_LEN>, requestCount> frames = {};
+	for (size_t idx = 0; idx < requestCount; idx++) {
+		frames[idx] = makeRequest(requestCodes[idx]);
+	}
+	return frames;
+}
+
+constexpr StaticFrame<FRAME_SET_MODE_LEN> makeMode(uint8_t mode, uint8_t value) {
+	return buildFrame<FRAME_SET_MODE_LEN>(FRAME_TYPE_CMD, SET_MODE_SRC, SET_MODE_DST, FRAME_DATA_TYPE_MODE_CHANGE, {mode, value, 0x00, 0x00});
+}
+
+constexpr StaticFrame<FRAME_OPERATION_MODE_LEN> makeOperationMode(uint8_t mode) {
+	return buildFrame<FRAME_OPERATION_MODE_LEN>(FRAME_TYPE_CMD, OPERATION_MODE_SRC, OPERATION_MODE_DST, FRAME_DATA_TYPE_OPERATION_MODE, {mode});
+}
+
+constexpr StaticFrame<FRAME_SWITCH_LEN> makeSwitch(uint8_t value) {
+	return buildFrame<FRAME_SWITCH_LEN>(FRAME_TYPE_CMD, SWITCH_SRC, SWITCH_DST, FRAME_DATA_TYPE_OPERATION_SWITCH, {value});
+}
+
+constexpr StaticFrame<FRAME_FORCE_DEFROST_LEN> makeDefrost(uint8_t onOff) {
+	return buildFrame<FRAME_FORCE_DEFROST_LEN>(FRAME_TYPE_CMD, FORCE_DEFROST_SRC, FORCE_DEFROST_DST, FRAME_DATA_TYPE_SPECIAL_CMD, {0x00, FORCE_DEFROST_CODE, onOff});
+}
+
+// [off, on], values as SetModeFrame::modeOnOff() and SwitchFrame::operationOnOff() compute them
+constexpr std::array<StaticFrame<FRAME_REQ_DATA_LEN>, requestCount> requestFrames = makeRequests();
+constexpr StaticFrame<FRAME_SET_MODE_LEN> autoModeFrames[] = {makeMode(SET_AUTO_MODE_CODE, 0x00), makeMode(SET_AUTO_MODE_CODE, 0x01)};
+constexpr StaticFrame<FRAME_SET_MODE_LEN> quietModeFrames[] = {makeMode(SET_QUIET_MODE_CODE, 0x00), makeMode(SET_QUIET_MODE_CODE, 0x01 << 2)};
+constexpr StaticFrame<FRAME_SET_MODE_LEN> nightModeFrames[] = {makeMode(SET_NIGHT_MODE_CODE, 0x00), makeMode(SET_NIGHT_MODE_CODE, 0x01 << 3)};
+constexpr StaticFrame<FRAME_OPERATION_MODE_LEN> coolingModeFrame = makeOperationMode(OPERATION_MODE_COOLING);
+constexpr StaticFrame<FRAME_OPERATION_MODE_LEN> heatingModeFrame = makeOperationMode(OPERATION_MODE_HEATING);
+constexpr StaticFrame<FRAME_SWITCH_LEN> coolHeatSwitchFrames[] = {makeSwitch(SWITCH_OPERATION_COOL_HEAT), makeSwitch(SWITCH_OPERATION_COOL_HEAT + 1)};
+constexpr StaticFrame<FRAME_SWITCH_LEN> hotWaterSwitchFrames[] = {makeSwitch(SWITCH_OPERATION_HOT_WATER), makeSwitch(SWITCH_OPERATION_HOT_WATER + (1 << 2))};
+constexpr StaticFrame<FRAME_FORCE_DEFROST_LEN> defrostFrames[] = {makeDefrost(0x00), makeDefrost(0x01)};
+
+// captured from the bus, see commands-frames.hpp
+static_assert(quietModeFrames[1][15] == 0xd3 && quietModeFrames[1][16] == 0xe9, "quiet mode on CRC");
+static_assert(coolingModeFrame[12] == 0xb1 && coolingModeFrame[13] == 0x7c, "cooling mode CRC");
+static_assert(hotWaterSwitchFrames[1][12] == 0x77 && hotWaterSwitchFrames[1][13] == 0xcf, "hot water on CRC");
+static_assert(defrostFrames[1][14] == 0xe7 && defrostFrames[1][15] == 0x25, "force defrost on CRC");
+
+template <size_t Len>
+static TxFrame tabled(const StaticFrame<Len>& frame, uint16_t dataType) {
+	TxFrame tx = {};
+	tx.table = frame.data();
+	tx.length = Len;
+	tx.dataType = dataType;
+	return tx;
+}
+
+template <size_t Len>
+static TxFrame built(const StaticFrame<Len>& frame, uint16_t dataType) {
+	static_assert(Len <= FRAME_TX_MAX_LEN, "frame too long for TxFrame");
+	TxFrame tx = {};
+	memcpy(tx.bytes, frame.data(), Len);
+	tx.length = Len;
+	tx.dataType = dataType;
+	return tx;
+}
+
+// tabled in REQUEST_CODES order, so the SensorRegistry ordinal is the index
+TxFrame FrameTables::request(uint8_t requestCode) {
+	uint8_t ordinal = SensorRegistry::ordinal(requestCode);
+	if (ordinal != SENSOR_NONE) { return tabled(requestFrames[ordinal], FRAME_DATA_TYPE_DATA_REQUEST); }
+	return built(makeRequest(requestCode), FRAME_DATA_TYPE_DATA_REQUEST);    // code outside RequestCode, rare
+}
+
+TxFrame FrameTables::mode(uint8_t mode, uint8_t onOff) {
+	uint8_t on = onOff ? 1 : 0;
+	switch (mode) {
+	case SET_AUTO_MODE_CODE:
+		return tabled(autoModeFrames[on], FRAME_DATA_TYPE_MODE_CHANGE);
+
+	case SET_QUIET_MODE_CODE:
+		return tabled(quietModeFrames[on], FRAME_DATA_TYPE_MODE_CHANGE);
+
+	case SET_NIGHT_MODE_CODE:
+		return tabled(nightModeFrames[on], FRAME_DATA_TYPE_MODE_CHANGE);
+	}
+	return built(makeMode(mode, onOff), FRAME_DATA_TYPE_MODE_CHANGE);
+}
+
+TxFrame FrameTables::operationMode(uint8_t mode) {
+	switch (mode) {
+	case OPERATION_MODE_COOLING:
+		return tabled(coolingModeFrame, FRAME_DATA_TYPE_OPERATION_MODE);
+
+	case OPERATION_MODE_HEATING:
+		return tabled(heatingModeFrame, FRAME_DATA_TYPE_OPERATION_MODE);
+	}
+	return built(makeOperationMode(mode), FRAME_DATA_TYPE_OPERATION_MODE);
+}
+
+TxFrame FrameTables::operationSwitch(uint8_t operation, uint8_t onOff) {
+	uint8_t on = onOff ? 1 : 0;
+	switch (operation) {
+	case SWITCH_OPERATION_COOL_HEAT:
+		return tabled(coolHeatSwitchFrames[on], FRAME_DATA_TYPE_OPERATION_SWITCH);
+
+	case SWITCH_OPERATION_HOT_WATER:
+		return tabled(hotWaterSwitchFrames[on], FRAME_DATA_TYPE_OPERATION_SWITCH);
+	}
+	return built(makeSwitch(onOff), FRAME_DATA_TYPE_OPERATION_SWITCH);
+}
+
+TxFrame FrameTables::forceDefrost(uint8_t onOff) {
+	return tabled(defrostFrames[onOff ? 1 : 0], FRAME_DATA_TYPE_SPECIAL_CMD);
+}
+
+// setpoints are runtime values: built on the stack with the same builder, no heap, table CRC kernel
+TxFrame FrameTables::temperature(uint8_t zone, uint8_t zone1Temperature, uint8_t zone2Temperature, uint8_t hotWaterTemperature) {
+	StaticPayload<FRAME_TEMPERATURE_LEN> payload = {zone};
+	uint8_t zone1 = TemperatureFrame::convertTemp(TemperatureFrame::constrainTemp(zone, zone1Temperature));
+	uint8_t zone2 = TemperatureFrame::convertTemp(TemperatureFrame::constrainTemp(zone, zone2Temperature));
+	uint8_t hotWater = TemperatureFrame::convertTemp(TemperatureFrame::constrainTemp(zone, hotWaterTemperature));
+	switch (zone) {
+	case TEMPERATURE_COOLING_CODE:
+	case TEMPERATURE_HEATING_CODE:
+		payload[TEMPERATURE_ZONE1_VALUE_OFFSET - FRAME_DATA_OFFSET] = zone1;
+		payload[TEMPERATURE_ZONE2_VALUE_OFFSET - FRAME_DATA_OFFSET] = zone2;
+		payload[TEMPERATURE_HOT_WATER_VALUE_OFFSET - FRAME_DATA_OFFSET] = hotWater;
+		payload[TEMPERATURE_ZONE1_VALUE2_OFFSET - FRAME_DATA_OFFSET] = zone1;
+		break;
+
+	case TEMPERATURE_HOT_WATER_CODE:
+		payload[TEMPERATURE_HOT_WATER_VALUE_OFFSET - FRAME_DATA_OFFSET] = hotWater;
+		break;
+	}
+	StaticFrame<FRAME_TEMPERATURE_LEN> frame = buildFrame<FRAME_TEMPERATURE_LEN>(FRAME_TYPE_CMD, TEMPERATURE_SRC, TEMPERATURE_DST, FRAME_DATA_TYPE_TEMPERATURE_CHANGE, payload, false);
+	uint16_t crc = Crc16::compute(frame.data(), FRAME_TEMPERATURE_LEN - FRAME_CRC_LEN);
+	frame[FRAME_TEMPERATURE_LEN - 2] = crc >> 8;
+	frame[FRAME_TEMPERATURE_LEN - 1] = crc & 0xff;
+	return built(frame, FRAME_DATA_TYPE_TEMPERATURE_CHANGE);
+}
@@ -0,0 +1,59 @@
+/*
+frame-tables.hpp - Estia R32 heat pump precomputed TX frames
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "commands-frames.hpp"
+#include "data-frames.hpp"
+#include "frame-builder.hpp"
+
+#define FRAME_TX_MAX_LEN FRAME_REQ_DATA_LEN    // longest frame we transmit
+
+/**
+* Frame ready to transmit.
+*
+* Points into a compile-time table, or carries its own bytes when it had to
+* be built at runtime (temperature change, request code not in the table).
+* Copyable, so it can sit in the command queue.
+*/
+struct TxFrame {
+	const uint8_t* table;
+	uint8_t bytes[FRAME_TX_MAX_LEN];
+	uint8_t length;
+	uint16_t dataType;
+
+	const uint8_t* data() const { return table ? table : bytes; }
+	uint8_t size() const { return length; }
+};
+
+/**
+* Request and command frames precomputed with `buildFrame()`.
+*
+* Every `RequestCode` and every mode/operation/switch/defrost on/off
+* combination is a constant table entry, so sending one copies nothing and
+* computes no CRC.
+*/
+class FrameTables {
+  public:
+	static TxFrame request(uint8_t requestCode);
+	static TxFrame mode(uint8_t mode, uint8_t onOff);
+	static TxFrame operationMode(uint8_t mode);
+	static TxFrame operationSwitch(uint8_t operation, uint8_t onOff);
+	static TxFrame forceDefrost(uint8_t onOff);
+	static TxFrame temperature(uint8_t zone, uint8_t zone1Temperature, uint8_t zone2Temperature, uint8_t hotWaterTemperature);
+};
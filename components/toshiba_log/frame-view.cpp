@@ -0,0 +1,48 @@
+/*
+frame-view.cpp - Estia R32 heat pump non-owning frame view
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "frame-view.hpp"
+
+FrameView::FrameView(const uint8_t* data, uint8_t length)
+    : bytes(data)
+    , length(length) {
+}
+
+FrameView::FrameView(const FrameBuffer& buffer)
+    : bytes(buffer.data())
+    , length(buffer.size() > 0xff ? 0xff : buffer.size()) {
+}
+
+bool FrameView::crcValid() const {
+	if (length < FRAME_MIN_LEN) { return false; }
+	return crc() == EstiaFrame::crc16(bytes, length - FRAME_CRC_LEN);
+}
+
+uint8_t FrameView::payloadLength() const {
+	if (length < FRAME_DATA_OFFSET + FRAME_CRC_LEN) { return 0; }
+	return length - FRAME_DATA_OFFSET - FRAME_CRC_LEN;
+}
+
+// same checks as EstiaFrame::checkFrame(), on the bytes as received
+uint8_t FrameView::check(uint8_t type, uint16_t dataType) const {
+	if (!crcValid()) { return EstiaFrame::err_crc; }
+	if (this->type() != type) { return EstiaFrame::err_frame_type; }
+	if (dataLength() != length - FRAME_HEAD_AND_CRC_LEN) { return EstiaFrame::err_data_len; }
+	if (this->dataType() != dataType) { return EstiaFrame::err_data_type; }
+	return EstiaFrame::err_ok;
+}
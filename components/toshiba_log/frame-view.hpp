@@ -0,0 +1,64 @@
+/*
+frame-view.hpp - Estia R32 heat pump non-owning frame view
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "frame.hpp"
+
+/**
+* Read-only view over a received frame, nothing is copied.
+*
+* Header fields are read in place, payload accessors index from
+* `FRAME_DATA_OFFSET` (first byte after the data type). Reads past the end
+* return 0, so checks on a short frame fail instead of faulting. The viewed
+* bytes must outlive the view.
+*/
+class FrameView {
+  private:
+	const uint8_t* bytes;
+	uint8_t length;
+
+  public:
+	FrameView(const uint8_t* data, uint8_t length);
+	FrameView(const FrameBuffer& buffer);
+
+	const uint8_t* data() const { return bytes; }
+	uint8_t size() const { return length; }
+	bool empty() const { return length == 0; }
+	const uint8_t* begin() const { return bytes; }
+	const uint8_t* end() const { return bytes + length; }
+	uint8_t at(uint8_t offset) const { return offset < length ? bytes[offset] : 0x00; }
+	uint8_t operator[](uint8_t offset) const { return at(offset); }
+	uint16_t readUint16(uint8_t offset) const { return (at(offset) << 8) | at(offset + 1); }
+
+	uint8_t type() const { return at(FRAME_TYPE_OFFSET); }
+	uint8_t dataLength() const { return at(FRAME_DATA_LEN_OFFSET); }
+	uint16_t src() const { return readUint16(FRAME_SRC_OFFSET); }
+	uint16_t dst() const { return readUint16(FRAME_DST_OFFSET); }
+	uint16_t dataType() const { return readUint16(FRAME_DATA_TYPE_OFFSET); }
+	uint16_t crc() const { return length >= FRAME_CRC_LEN ? readUint16(length - FRAME_CRC_LEN) : 0x0000; }
+	bool crcValid() const;
+
+	uint8_t payloadLength() const;
+	uint8_t payloadUint8(uint8_t index) const { return at(FRAME_DATA_OFFSET + index); }
+	uint16_t payloadUint16(uint8_t index) const { return readUint16(FRAME_DATA_OFFSET + index); }
+	int16_t payloadInt16(uint8_t index) const { return static_cast<int16_t>(payloadUint16(index)); }
+	bool payloadFlag(uint8_t index, uint8_t mask) const { return (payloadUint8(index) & mask) == mask; }
+
+	uint8_t check(uint8_t type, uint16_t dataType) const;    // EstiaFrame::Error
+};
@@ -17,32 +17,33 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 */
 
 #include "frame.hpp"
+#include "frame-view.hpp"
+#include <stdio.h>
 
-// frame from buffer (rvalue)
+// frame from buffer (rvalue), takes over the buffer
 EstiaFrame::EstiaFrame(FrameBuffer&& buffer, uint8_t length)
-    : length(length)
-    , buffer(buffer)
+    : buffer(std::move(buffer))
+    , length(length)
     , type(0x00)
     , dataLength(0x00)
     , src(0x0000)
     , dst(0x0000)
     , dataType(0x0000)
     , crc(0x0000) {
-	if (length < FRAME_MIN_LEN) {    // ensure minimum buffer size
-		this->length = FRAME_MIN_LEN;
-	}
-	this->buffer.resize(this->length, 0x00);    // resize to proper length
-	type = this->buffer.at(FRAME_TYPE_OFFSET);
-	dataLength = this->buffer.at(FRAME_DATA_LEN_OFFSET);
-	src = readUint16(FRAME_SRC_OFFSET);
-	dst = readUint16(FRAME_DST_OFFSET);
-	dataType = readUint16(FRAME_DATA_TYPE_OFFSET);
-	crc = readUint16(this->length - 2);
+	readHeader();
 }
 
-// frame from buffer (lvalue)
-EstiaFrame::EstiaFrame(FrameBuffer& buffer, uint8_t length)
-    : EstiaFrame::EstiaFrame(std::forward<FrameBuffer>(buffer), length) {
+// frame from buffer (lvalue), copies the buffer
+EstiaFrame::EstiaFrame(const FrameBuffer& buffer, uint8_t length)
+    : buffer(buffer)
+    , length(length)
+    , type(0x00)
+    , dataLength(0x00)
+    , src(0x0000)
+    , dst(0x0000)
+    , dataType(0x0000)
+    , crc(0x0000) {
+	readHeader();
 }
 
 // frame with type, empty data and no crc
@@ -64,6 +65,19 @@ EstiaFrame::EstiaFrame(uint8_t type, uint8_t length)
 	buffer.at(FRAME_DATA_LEN_OFFSET) = dataLength;
 }
 
+void EstiaFrame::readHeader() {
+	if (length < FRAME_MIN_LEN) {    // ensure minimum buffer size
+		length = FRAME_MIN_LEN;
+	}
+	buffer.resize(length, 0x00);    // resize to proper length
+	type = buffer.at(FRAME_TYPE_OFFSET);
+	dataLength = buffer.at(FRAME_DATA_LEN_OFFSET);
+	src = readUint16(FRAME_SRC_OFFSET);
+	dst = readUint16(FRAME_DST_OFFSET);
+	dataType = readUint16(FRAME_DATA_TYPE_OFFSET);
+	crc = readUint16(length - 2);
+}
+
 bool EstiaFrame::setByte(uint8_t offset, uint8_t value, bool updateCrc) {
 	if (offset >= length) { return false; }
 
@@ -94,23 +108,43 @@ bool EstiaFrame::insertData(uint8_t* data, bool incHeader, bool updateCrc) {
 	return true;
 }
 
-String EstiaFrame::stringify() {
+std::string EstiaFrame::stringify() {
 	return stringify(this->buffer);
 }
 
+static const char hexDigits[] = "0123456789abcdef";
+
 template <typename Buffer>
-String EstiaFrame::stringify(const Buffer& buffer) {
-	String stringifyBuffer = "";
+std::string EstiaFrame::stringify(const Buffer& buffer) {
+	std::string stringifyBuffer;
+	stringifyBuffer.reserve(buffer.size() * 3);
 	for (auto& byte : buffer) {
-		if (byte < 0x10) { stringifyBuffer += "0"; }
-		stringifyBuffer += String(byte, HEX) + " ";
+		stringifyBuffer.push_back(hexDigits[byte >> 4]);
+		stringifyBuffer.push_back(hexDigits[byte & 0x0f]);
+		stringifyBuffer.push_back(' ');
 	}
-	stringifyBuffer.trim();
+	if (!stringifyBuffer.empty()) { stringifyBuffer.pop_back(); }    // trailing space
 	return stringifyBuffer;
 }
 
-template String EstiaFrame::stringify<FrameBuffer>(const FrameBuffer& buffer);
-template String EstiaFrame::stringify<ReadBuffer>(const ReadBuffer& buffer);
+// bytes that do not fit `outSize` are left out, `out` is always terminated
+size_t EstiaFrame::toHex(const uint8_t* data, size_t len, char* out, size_t outSize) {
+	if (outSize == 0) { return 0; }
+
+	size_t pos = 0;
+	for (size_t idx = 0; idx < len; idx++) {
+		if (pos + (idx > 0 ? 3 : 2) >= outSize) { break; }
+		if (idx > 0) { out[pos++] = ' '; }
+		out[pos++] = hexDigits[data[idx] >> 4];
+		out[pos++] = hexDigits[data[idx] & 0x0f];
+	}
+	out[pos] = '\0';
+	return pos;
+}
+
+template std::string EstiaFrame::stringify<FrameBuffer>(const FrameBuffer& buffer);
+template std::string EstiaFrame::stringify<ReadBuffer>(const ReadBuffer& buffer);
+template std::string EstiaFrame::stringify<FrameView>(const FrameView& buffer);
 
 void EstiaFrame::setSrc(uint16_t src, bool updateCrc) {
 	this->src = src;
@@ -166,29 +200,11 @@ uint16_t EstiaFrame::readUint16(const Buffer& buffer, uint8_t offset) {
 	return (buffer.at(offset) << 8) | buffer.at(offset + 1);
 }
 
-// https://gist.github.com/aurelj/270bb8af82f65fa645c1?permalink_comment_id=2884584#gistcomment-2884584
-uint16_t EstiaFrame::crc16(uint8_t* data, size_t len) {
-	uint16_t crc = 0xffff;
-	uint8_t L;
-	uint8_t t;
-	if (!data || len <= 0) { return crc; }
-	while (len--) {
-		crc ^= *data++;
-		L = crc ^ (crc << 4);
-		t = (L << 3) | (L >> 5);
-		L ^= (t & 0x07);
-		t = (t & 0xf8) ^ (((t << 1) | (t >> 7)) & 0x0f) ^ (uint8_t)(crc >> 8);
-		crc = (L << 8) | t;
-	}
-	return crc;
-}
+template uint16_t EstiaFrame::readUint16<FrameBuffer>(const FrameBuffer& buffer, uint8_t offset);
+template uint16_t EstiaFrame::readUint16<ReadBuffer>(const ReadBuffer& buffer, uint8_t offset);
 
-FrameBuffer EstiaFrame::readBuffToFrameBuff(const ReadBuffer& buffer) {
-	FrameBuffer frameBuffer;
-	for (auto& byte : buffer) {
-		frameBuffer.push_back(byte);
-	}
-	return frameBuffer;
+uint16_t EstiaFrame::crc16(const uint8_t* data, size_t len) {
+	return Crc16::compute(data, len);
 }
 
 template <typename Buffer>
@@ -201,6 +217,7 @@ bool EstiaFrame::isStatusFrame(const Buffer& buffer) {
 
 template bool EstiaFrame::isStatusFrame<ReadBuffer>(const ReadBuffer& buffer);
 template bool EstiaFrame::isStatusFrame<FrameBuffer>(const FrameBuffer& buffer);
+template bool EstiaFrame::isStatusFrame<FrameView>(const FrameView& buffer);
 
 template <typename Buffer>
 bool EstiaFrame::isStatusUpdateFrame(const Buffer& buffer) {
@@ -212,6 +229,7 @@ bool EstiaFrame::isStatusUpdateFrame(const Buffer& buffer) {
 
 template bool EstiaFrame::isStatusUpdateFrame<ReadBuffer>(const ReadBuffer& buffer);
 template bool EstiaFrame::isStatusUpdateFrame<FrameBuffer>(const FrameBuffer& buffer);
+template bool EstiaFrame::isStatusUpdateFrame<FrameView>(const FrameView& buffer);
 
 template <typename Buffer>
 bool EstiaFrame::isAckFrame(const Buffer& buffer) {
@@ -223,6 +241,7 @@ bool EstiaFrame::isAckFrame(const Buffer& buffer) {
 
 template bool EstiaFrame::isAckFrame<ReadBuffer>(const ReadBuffer& buffer);
 template bool EstiaFrame::isAckFrame<FrameBuffer>(const FrameBuffer& buffer);
+template bool EstiaFrame::isAckFrame<FrameView>(const FrameView& buffer);
 
 template <typename Buffer>
 bool EstiaFrame::isDataResFrame(const Buffer& buffer) {
@@ -234,3 +253,4 @@ bool EstiaFrame::isDataResFrame(const Buffer& buffer) {
 
 template bool EstiaFrame::isDataResFrame<ReadBuffer>(const ReadBuffer& buffer);
 template bool EstiaFrame::isDataResFrame<FrameBuffer>(const FrameBuffer& buffer);
+template bool EstiaFrame::isDataResFrame<FrameView>(const FrameView& buffer);
@@ -18,10 +18,10 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
-#include <Print.h>
-#include <WString.h>
-#include <deque>
+#include "crc16.hpp"
+#include "ring-buffer.hpp"
 #include <stdint.h>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -95,7 +95,13 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 #define FRAME_STATUS2_LEN 15
 #define FRAME_SHORT_STATUS_LEN 17
 
-using ReadBuffer = std::deque<uint8_t>;
+#define FRAME_HEX_SIZE ((FRAME_MAX_LEN + 2) * 3)    // "xx " per byte of a fixed frame, last space is the NUL
+
+#define READ_BUFFER_FRAMES 4    // frames in flight between UART FIFO and framer
+#define READ_BUFFER_SIZE 256    // next power of two >= FRAME_MAX_LEN * READ_BUFFER_FRAMES
+static_assert(READ_BUFFER_SIZE >= FRAME_MAX_LEN * READ_BUFFER_FRAMES, "read buffer too small for frames in flight");
+
+using ReadBuffer = RingBuffer<uint8_t, READ_BUFFER_SIZE>;
 using FrameBuffer = std::vector<uint8_t>;
 
 class EstiaFrame {
@@ -119,6 +125,7 @@ class EstiaFrame {
 	uint16_t readUint16(uint8_t offset);
 	uint8_t checkFrame(uint8_t type, uint16_t dataType);
 	void updateCrc();
+	void readHeader();
 
   public:
 	enum Error {
@@ -131,7 +138,7 @@ class EstiaFrame {
 	};
 
 	EstiaFrame(FrameBuffer&& buffer, uint8_t length);
-	EstiaFrame(FrameBuffer& buffer, uint8_t length);
+	EstiaFrame(const FrameBuffer& buffer, uint8_t length);
 	EstiaFrame(uint8_t type, uint8_t length);
 
 	const uint8_t* data() const;
@@ -140,11 +147,11 @@ class EstiaFrame {
 	static bool writeUint16(Buffer& buffer, uint8_t offset, uint16_t data);
 	template <typename Buffer>
 	static uint16_t readUint16(const Buffer& buffer, uint8_t offset);
-	static uint16_t crc16(uint8_t* data, size_t len);    // CRC-16/MCRF4XX
-	String stringify();
+	static uint16_t crc16(const uint8_t* data, size_t len);    // CRC-16/MCRF4XX
+	std::string stringify();
 	template <typename Buffer>
-	static String stringify(const Buffer& buffer);
-	static FrameBuffer readBuffToFrameBuff(const ReadBuffer& buffer);
+	static std::string stringify(const Buffer& buffer);
+	static size_t toHex(const uint8_t* data, size_t len, char* out, size_t outSize);    // no heap, returns length
 	template <typename Buffer>
 	static bool isStatusFrame(const Buffer& buffer);
 	template <typename Buffer>
@@ -0,0 +1,51 @@
+/*
+publish-filter.cpp - Deadband and rate limit for published sensor values
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "publish-filter.hpp"
+#include <math.h>
+
+PublishFilter::PublishFilter()
+    : policy({0, 0, 0, PUBLISH_DEFAULT_HEARTBEAT})
+    , last(0)
+    , lastTime(0)
+    , published(false) {
+}
+
+bool PublishFilter::changed(float value) const {
+	if (isnan(value) || isnan(last)) { return isnan(value) != isnan(last); }
+
+	float delta = fabsf(value - last);
+	if (delta == 0) { return false; }
+	float threshold = policy.deadband;
+	float relative = policy.relativeDeadband * fabsf(last);
+	if (relative > threshold) { threshold = relative; }
+	return delta >= threshold;
+}
+
+bool PublishFilter::publish(float value, uint32_t now) {
+	if (published) {
+		uint32_t elapsed = now - lastTime;
+		if (elapsed < policy.minInterval) { return false; }
+		bool due = policy.heartbeat > 0 && elapsed >= policy.heartbeat;
+		if (!due && !changed(value)) { return false; }
+	}
+	last = value;
+	lastTime = now;
+	published = true;
+	return true;
+}
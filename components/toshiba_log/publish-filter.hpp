@@ -0,0 +1,58 @@
+/*
+publish-filter.hpp - Deadband and rate limit for published sensor values
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#define PUBLISH_DEFAULT_HEARTBEAT 600000    // ms, unchanged values are republished this often
+
+struct PublishPolicy {
+	float deadband;          // sensor units, smallest change worth publishing, 0 = any change
+	float relativeDeadband;  // fraction of the last published value, 0 = off
+	uint32_t minInterval;    // ms between two publishes
+	uint32_t heartbeat;      // ms after which an unchanged value is published again, 0 = never
+};
+
+/**
+* Decides whether a new value of one sensor is worth publishing.
+*
+* Values are compared against the last published one, so a slow drift
+* inside the deadband still goes out once it adds up. A change that comes
+* before `minInterval` is held back and goes out with the first value after
+* it that still differs. NAN (no data, error) against a number is always a
+* change. With the default policy only changes are published, plus an
+* unchanged value every `PUBLISH_DEFAULT_HEARTBEAT`.
+*/
+class PublishFilter {
+  private:
+	PublishPolicy policy;
+	float last;
+	uint32_t lastTime;
+	bool published;
+
+	bool changed(float value) const;
+
+  public:
+	PublishFilter();
+
+	void setPolicy(const PublishPolicy& policy) { this->policy = policy; }
+	const PublishPolicy& getPolicy() const { return policy; }
+	bool publish(float value, uint32_t now);    // true: publish it, recorded as the last published value
+	void reset() { published = false; }
+};
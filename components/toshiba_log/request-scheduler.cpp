@@ -0,0 +1,66 @@
+/*
+request-scheduler.cpp - Age-of-information scheduling of data requests
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "request-scheduler.hpp"
+
+RequestScheduler::RequestScheduler()
+    : sensors() {
+}
+
+uint8_t RequestScheduler::add(uint8_t code, uint32_t maxAge) {
+	sensors.push_back({code, maxAge > 0 ? maxAge : 1, 0, 0, false});
+	return sensors.size() - 1;
+}
+
+uint32_t RequestScheduler::staleness(const ScheduledSensor& sensor, uint32_t now, uint32_t minAge) const {
+	if (!sensor.valid) { return UINT32_MAX; }
+
+	uint32_t target = sensor.maxAge > minAge ? sensor.maxAge : minAge;
+	uint64_t ratio = static_cast<uint64_t>(now - sensor.updated) * 1000 / target;
+	return ratio < UINT32_MAX ? ratio : UINT32_MAX - 1;
+}
+
+int16_t RequestScheduler::next(uint32_t now, uint32_t minAge) const {
+	int16_t stalest = SCHEDULER_NONE;
+	uint32_t stalestRatio = 0;
+	for (size_t idx = 0; idx < sensors.size(); idx++) {
+		const ScheduledSensor& sensor = sensors[idx];
+		bool failed = sensor.attempted != sensor.updated || !sensor.valid;
+		if (failed && sensor.attempted != 0 && now - sensor.attempted < SCHEDULER_RETRY_DELAY) { continue; }
+
+		uint32_t ratio = staleness(sensor, now, minAge);
+		if (ratio < 1000) { continue; }    // younger than its target
+		if (stalest == SCHEDULER_NONE || ratio > stalestRatio) {
+			stalest = idx;
+			stalestRatio = ratio;
+		}
+	}
+	return stalest;
+}
+
+void RequestScheduler::requested(uint8_t index, uint32_t now) {
+	sensors[index].attempted = now;
+}
+
+void RequestScheduler::completed(uint8_t index, uint32_t now, bool answered) {
+	if (!answered) { return; }
+
+	sensors[index].updated = now;
+	sensors[index].attempted = now;
+	sensors[index].valid = true;
+}
@@ -0,0 +1,66 @@
+/*
+request-scheduler.hpp - Age-of-information scheduling of data requests
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define SCHEDULER_DEFAULT_MAX_AGE 30000    // ms
+#define SCHEDULER_RETRY_DELAY 2000         // ms before a failed request is tried again
+#define SCHEDULER_NONE -1
+
+struct ScheduledSensor {
+	uint8_t code;         // RequestCode
+	uint32_t maxAge;      // ms, freshness target
+	uint32_t updated;     // ms, last answer
+	uint32_t attempted;   // ms, last request
+	bool valid;           // `updated` holds a time
+};
+
+/**
+* Picks the data request for the next free bus slot.
+*
+* Every sensor has a maximum age. A sensor is due once its value is older
+* than that, and of the due sensors the one with the largest age relative
+* to its target goes first, so a 10 s sensor is asked six times while a
+* 60 s one is asked once and slow counters don't hold up fast temperatures.
+* Sensors without a value yet are due right away, in the order they were
+* added. An answer refreshes the sensor even if it carries no value (the
+* unit doesn't have that sensor), an unanswered request leaves it stale and
+* due again after `SCHEDULER_RETRY_DELAY`.
+*/
+class RequestScheduler {
+  private:
+	std::vector<ScheduledSensor> sensors;
+
+	uint32_t staleness(const ScheduledSensor& sensor, uint32_t now, uint32_t minAge) const;    // age per mille of target
+
+  public:
+	RequestScheduler();
+
+	uint8_t add(uint8_t code, uint32_t maxAge = SCHEDULER_DEFAULT_MAX_AGE);    // sensor index
+	// stalest due sensor, SCHEDULER_NONE if none; targets below `minAge` count as `minAge`
+	int16_t next(uint32_t now, uint32_t minAge = 0) const;
+	void requested(uint8_t index, uint32_t now);
+	void completed(uint8_t index, uint32_t now, bool answered);
+	const ScheduledSensor& sensor(uint8_t index) const { return sensors[index]; }
+	size_t size() const { return sensors.size(); }
+	void clear() { sensors.clear(); }
+};
@@ -0,0 +1,94 @@
+/*
+request-timing.cpp - Adaptive data request timeouts
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "request-timing.hpp"
+#include <string.h>
+
+void RttEstimate::add(uint16_t rtt) {
+	if (samples == 0) {
+		srtt8 = rtt << 3;
+		rttvar4 = rtt << 1;    // rtt / 2
+	} else {
+		int32_t delta = static_cast<int32_t>(rtt) - srtt();
+		srtt8 += delta;    // srtt += delta / 8
+		uint16_t deviation = delta < 0 ? -delta : delta;
+		rttvar4 += static_cast<int32_t>(deviation) - rttvar();    // rttvar += (|delta| - rttvar) / 4
+	}
+	if (samples < UINT16_MAX) { samples++; }
+}
+
+RequestTiming::RequestTiming(uint16_t fixedTimeout, uint16_t fixedDelay)
+    : estimates()
+    , bus()
+    , fixedTimeout(fixedTimeout)
+    , fixedDelay(fixedDelay)
+    , backoff(0) {
+}
+
+size_t RequestTiming::slot(uint8_t code) {
+	uint8_t ordinal = SensorRegistry::ordinal(code);
+	return ordinal != SENSOR_NONE ? ordinal : SENSOR_REGISTRY_SIZE;
+}
+
+const RttEstimate& RequestTiming::estimate(uint8_t code) const {
+	const RttEstimate& own = estimates[slot(code)];
+	return own.samples > 0 ? own : bus;
+}
+
+void RequestTiming::sample(uint8_t code, uint32_t rtt) {
+	if (rtt > REQUEST_TIMING_MAX_TIMEOUT) { return; }    // not an answer to this request
+
+	estimates[slot(code)].add(rtt);
+	bus.add(rtt);
+	backoff = 0;
+}
+
+void RequestTiming::timedOut() {
+	if (backoff < REQUEST_TIMING_MAX_BACKOFF) { backoff++; }
+}
+
+uint32_t RequestTiming::timeout(uint8_t code) const {
+	const RttEstimate& rtt = estimate(code);
+	uint32_t base = fixedTimeout;
+	if (rtt.samples > 0) {
+		uint32_t margin = 4 * rtt.rttvar();
+		base = rtt.srtt() + (margin > REQUEST_TIMING_GRANULARITY ? margin : REQUEST_TIMING_GRANULARITY);
+	}
+	uint32_t backedOff = base << backoff;
+	return backedOff < REQUEST_TIMING_MAX_TIMEOUT ? backedOff : REQUEST_TIMING_MAX_TIMEOUT;
+}
+
+uint32_t RequestTiming::expected(uint8_t code) const {
+	const RttEstimate& rtt = estimate(code);
+	if (rtt.samples == 0) { return fixedTimeout; }
+	return rtt.srtt() + 2 * rtt.rttvar();
+}
+
+uint32_t RequestTiming::delay() const {
+	if (bus.samples == 0) { return fixedDelay; }
+
+	int32_t turnaround = bus.srtt() - REQUEST_TIMING_RESPONSE_AIRTIME + 2 * bus.rttvar();
+	if (turnaround < REQUEST_TIMING_MIN_DELAY) { return REQUEST_TIMING_MIN_DELAY; }
+	return static_cast<uint32_t>(turnaround) < fixedDelay ? turnaround : fixedDelay;
+}
+
+void RequestTiming::reset() {
+	memset(estimates, 0, sizeof(estimates));
+	bus = RttEstimate();
+	backoff = 0;
+}
@@ -0,0 +1,87 @@
+/*
+request-timing.hpp - Adaptive data request timeouts
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "data-frames.hpp"
+#include "sensor-registry.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+#define REQUEST_TIMING_GRANULARITY 16                          // ms, loop period the response is seen with
+#define REQUEST_TIMING_MAX_TIMEOUT 1000                        // ms
+#define REQUEST_TIMING_MAX_BACKOFF 4                           // timeout doublings
+#define REQUEST_TIMING_MIN_DELAY 20                            // ms, one frame gap
+#define REQUEST_TIMING_RESPONSE_AIRTIME (FRAME_RES_DATA_LEN * 46 / 10)    // ms, 11 bits per byte at 2400 baud
+
+/**
+* Smoothed response time of one request code, TCP retransmission timer
+* style (RFC 6298): `srtt` moves 1/8 and `rttvar` 1/4 of the way to each
+* sample. Both are kept in ms scaled by 8 and 4 to stay in integers.
+*/
+struct RttEstimate {
+	uint16_t srtt8;
+	uint16_t rttvar4;
+	uint16_t samples;
+
+	void add(uint16_t rtt);
+	uint16_t srtt() const { return srtt8 >> 3; }
+	uint16_t rttvar() const { return rttvar4 >> 2; }
+};
+
+/**
+* Request timeout and spacing learned from the bus.
+*
+* The response time runs from the end of our request to the decoded
+* response, i.e. master turnaround, response airtime and the frame gap.
+* Each request code gets `srtt + 4 * rttvar`, the same margin TCP uses,
+* doubled per timeout. The backoff is not tied to one request: it covers
+* the retries of that request and keeps later requests backed off until
+* the next sample, so a bus slower than the fixed timeout still yields
+* samples. Codes without samples yet borrow the estimate of all
+* codes, and before the first response the fixed timeout and delay given to
+* the constructor apply. Responses to retried requests are not sampled,
+* they may answer an earlier attempt (Karn's algorithm).
+*
+* The spacing before the next request covers the master's own turnaround
+* after a response, the learned response time less the response airtime.
+* It never exceeds the fixed delay.
+*/
+class RequestTiming {
+  private:
+	RttEstimate estimates[SENSOR_REGISTRY_SIZE + 1];    // by ordinal, one shared slot follows for other codes
+	RttEstimate bus;    // all codes
+	uint16_t fixedTimeout;
+	uint16_t fixedDelay;
+	uint8_t backoff;    // timeouts since the last sample
+
+	const RttEstimate& estimate(uint8_t code) const;
+	static size_t slot(uint8_t code);
+
+  public:
+	RequestTiming(uint16_t fixedTimeout, uint16_t fixedDelay);
+
+	void sample(uint8_t code, uint32_t rtt);
+	void timedOut();
+	uint32_t timeout(uint8_t code) const;
+	uint32_t expected(uint8_t code) const;    // likely response time, for slot planning
+	uint32_t delay() const;
+	const RttEstimate& busEstimate() const { return bus; }
+	const RttEstimate& codeEstimate(uint8_t code) const { return estimates[slot(code)]; }
+	void reset();
+};
@@ -0,0 +1,156 @@
+/*
+ring-buffer.hpp - Estia R32 heat pump fixed-capacity ring buffer
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+* Statically sized FIFO with power-of-two capacity, no heap allocation.
+*
+* Mirrors the parts of `std::deque` the RX path uses (`push_back`,
+* `pop_front`, `front`, `at`, iteration) and adds contiguous span access so
+* bulk copies out of the buffer are at most two `memcpy`-able runs. When
+* full, `push_back` drops the oldest element: on RX the newest bytes matter,
+* the framer resyncs on the next `FRAME_BEGIN`.
+*/
+template <typename T, size_t Capacity>
+class RingBuffer {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "RingBuffer capacity must be a power of two");
+
+  private:
+	T storage[Capacity];
+	size_t head;    // index of the first element, unmasked
+	size_t count;
+	uint32_t overruns;
+
+	static size_t mask(size_t index) { return index & (Capacity - 1); }
+
+  public:
+	struct Span {
+		const T* data;
+		size_t size;
+	};
+
+	class const_iterator {
+	  private:
+		const RingBuffer* ring;
+		size_t index;
+
+	  public:
+		const_iterator(const RingBuffer* ring, size_t index)
+		    : ring(ring)
+		    , index(index) {}
+
+		const T& operator*() const { return ring->at(index); }
+		const_iterator& operator++() {
+			index++;
+			return *this;
+		}
+		bool operator!=(const const_iterator& other) const { return index != other.index; }
+		bool operator==(const const_iterator& other) const { return index == other.index; }
+	};
+
+	RingBuffer()
+	    : storage()
+	    , head(0)
+	    , count(0)
+	    , overruns(0) {}
+
+	static constexpr size_t capacity() { return Capacity; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	bool full() const { return count == Capacity; }
+	uint32_t overrunCount() const { return overruns; }
+
+	void clear() {
+		head = 0;
+		count = 0;
+	}
+
+	bool push_back(const T& value) {
+		bool dropped = false;
+		if (full()) {
+			pop_front();
+			overruns++;
+			dropped = true;
+		}
+		storage[mask(head + count)] = value;
+		count++;
+		return !dropped;
+	}
+
+	void pop_front() {
+		if (empty()) { return; }
+		head = mask(head + 1);
+		count--;
+	}
+
+	// remove one element, later elements move up (O(n), for rare out of order removal)
+	void erase(size_t index) {
+		if (index >= count) { return; }
+		for (size_t idx = index; idx + 1 < count; idx++) {
+			at(idx) = at(idx + 1);
+		}
+		count--;
+	}
+
+	// drop the first `len` elements
+	void discard(size_t len) {
+		if (len >= count) {
+			clear();
+			return;
+		}
+		head = mask(head + len);
+		count -= len;
+	}
+
+	T& front() { return storage[head]; }
+	const T& front() const { return storage[head]; }
+	T& back() { return storage[mask(head + count - 1)]; }
+	const T& back() const { return storage[mask(head + count - 1)]; }
+	T& at(size_t index) { return storage[mask(head + index)]; }
+	const T& at(size_t index) const { return storage[mask(head + index)]; }
+	T& operator[](size_t index) { return at(index); }
+	const T& operator[](size_t index) const { return at(index); }
+
+	// elements from front up to the end of storage, and the wrapped remainder
+	Span first() const {
+		size_t run = Capacity - head;
+		return {storage + head, count < run ? count : run};
+	}
+	Span second() const {
+		size_t run = Capacity - head;
+		return {storage, count > run ? count - run : 0};
+	}
+
+	// copy up to `len` elements from the front without consuming them
+	size_t copy(T* out, size_t len) const {
+		size_t copied = 0;
+		for (const Span& span : {first(), second()}) {
+			for (size_t idx = 0; idx < span.size && copied < len; idx++) {
+				out[copied++] = span.data[idx];
+			}
+		}
+		return copied;
+	}
+
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, count); }
+};
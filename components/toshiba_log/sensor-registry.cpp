@@ -0,0 +1,101 @@
+/*
+sensor-registry.cpp - Dense table of requestable data points
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "sensor-registry.hpp"
+#include "config.h"
+#include <array>
+
+constexpr uint8_t registryCodes[] = {REQUEST_CODES};
+static_assert(sizeof(registryCodes) == SENSOR_REGISTRY_SIZE, "SENSOR_REGISTRY_SIZE out of sync with REQUEST_CODES");
+
+constexpr std::array<uint8_t, 256> makeOrdinals() {
+	std::array<uint8_t, 256> ordinals = {};
+	for (size_t code = 0; code < ordinals.size(); code++) {
+		ordinals[code] = SENSOR_NONE;
+	}
+	for (size_t idx = 0; idx < SENSOR_REGISTRY_SIZE; idx++) {
+		ordinals[registryCodes[idx]] = idx;
+	}
+	return ordinals;
+}
+
+constexpr std::array<uint8_t, 256> codeOrdinals = makeOrdinals();
+
+SensorRegistry::SensorRegistry()
+    : slots() {
+	for (const auto& entry : requestsMap) {
+		uint8_t idx = ordinal(entry.second.code);
+		if (idx == SENSOR_NONE) { continue; }
+		slots[idx].multiplier = entry.second.multiplier;
+	}
+	for (size_t idx = 0; idx < SENSOR_REGISTRY_SIZE; idx++) {
+		slots[idx].code = registryCodes[idx];
+	}
+}
+
+uint8_t SensorRegistry::ordinal(uint8_t code) {
+	return codeOrdinals[code];
+}
+
+uint8_t SensorRegistry::ordinal(const std::string& name) {
+	auto it = requestsMap.find(name);
+	return it != requestsMap.end() ? ordinal(it->second.code) : SENSOR_NONE;
+}
+
+uint8_t SensorRegistry::code(uint8_t ordinal) {
+	return registryCodes[ordinal];
+}
+
+// configuration and diagnostics only, walks requestsMap
+const char* SensorRegistry::name(uint8_t ordinal) {
+	for (const auto& entry : requestsMap) {
+		if (entry.second.code == registryCodes[ordinal]) { return entry.first.c_str(); }
+	}
+	return "";
+}
+
+SensorList SensorRegistry::resolve(std::initializer_list<const char*> names) {
+	SensorList ordinals;
+	for (const char* name : names) {
+		uint8_t idx = ordinal(std::string(name));
+		if (idx != SENSOR_NONE) { ordinals.push_back(idx); }
+	}
+	return ordinals;
+}
+
+const SensorList& SensorRegistry::defaults() {
+	static const SensorList list = resolve({SENSORS_DATA_TO_REQUEST});
+	return list;
+}
+
+void SensorRegistry::store(uint8_t ordinal, int16_t value, SensorStatus status, uint32_t now) {
+	SensorSlot& slot = slots[ordinal];
+	slot.value = value;
+	slot.status = status;
+	slot.updated = now;
+	if (status != sensor_failed) { slot.failures = 0; }
+}
+
+void SensorRegistry::clear() {
+	for (SensorSlot& slot : slots) {
+		slot.value = 0;
+		slot.status = sensor_unset;
+		slot.updated = 0;
+		slot.failures = 0;
+	}
+}
@@ -0,0 +1,76 @@
+/*
+sensor-registry.hpp - Dense table of requestable data points
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "data-frames.hpp"
+#include <initializer_list>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define SENSOR_REGISTRY_SIZE 33    // entries of REQUEST_CODES
+#define SENSOR_NONE 0xff           // code or name outside REQUEST_CODES
+
+enum SensorStatus : uint8_t {
+	sensor_unset,     // never answered
+	sensor_valid,     // `value` holds data
+	sensor_empty,     // answered, the unit doesn't have this data point
+	sensor_failed,    // `value` holds the EstiaSerial::ResponseError of the last request
+};
+
+struct SensorSlot {
+	uint8_t code;          // RequestCode
+	float multiplier;
+	int16_t value;         // raw, scale with `multiplier`
+	uint32_t updated;      // ms, last store
+	SensorStatus status;
+	uint8_t failures;      // failed requests in a row, not yet stored
+};
+
+using SensorList = std::vector<uint8_t>;    // ordinals, in request order
+
+/**
+* Every `RequestCode` at a fixed ordinal, its position in `REQUEST_CODES`.
+*
+* Names are resolved to ordinals once, at configuration time, through
+* `requestsMap`. From then on requests, responses and publishing index this
+* table: `ordinal(code)` is one lookup in a 256-entry byte table, and the
+* ordinal also indexes `FrameTables` request frames and `RequestTiming`.
+*/
+class SensorRegistry {
+  private:
+	SensorSlot slots[SENSOR_REGISTRY_SIZE];
+
+  public:
+	SensorRegistry();
+
+	static uint8_t ordinal(uint8_t code);
+	static uint8_t ordinal(const std::string& name);
+	static uint8_t code(uint8_t ordinal);
+	static const char* name(uint8_t ordinal);
+	static SensorList resolve(std::initializer_list<const char*> names);    // unknown names are skipped
+	static const SensorList& defaults();                                   // SENSORS_DATA_TO_REQUEST
+
+	SensorSlot& operator[](uint8_t ordinal) { return slots[ordinal]; }
+	const SensorSlot& operator[](uint8_t ordinal) const { return slots[ordinal]; }
+	void store(uint8_t ordinal, int16_t value, SensorStatus status, uint32_t now);
+	void clear();    // values, codes and multipliers stay
+	static constexpr size_t size() { return SENSOR_REGISTRY_SIZE; }
+};
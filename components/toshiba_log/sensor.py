@@ -21,6 +21,30 @@ from esphome.const import (
 
 from . import CONF_TOSHIBA_LOG_ID, ToshibaLog
 
+CONF_MAX_AGE = "max_age"
+CONF_PUBLISH = "publish"
+CONF_DEADBAND = "deadband"
+CONF_RELATIVE_DEADBAND = "relative_deadband"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_HEARTBEAT = "heartbeat"
+
+# how stale a data point may get before the scheduler requests it again;
+# counters and the firmware version barely move, see RequestScheduler
+DATA_SENSOR_MAX_AGE = "30s"
+DATA_SENSOR_SLOW_MAX_AGE = "10min"
+DATA_SENSOR_SLOW_TYPES = {"sw_ver"}
+
+# which new values reach publish_state(), see PublishFilter: changes of at
+# least the deadband (absolute, or relative to the last published value),
+# no closer together than min_interval, an unchanged value every heartbeat
+# ("0s" never); by default every change plus a 10min heartbeat
+PUBLISH_SCHEMA = cv.Schema({
+    cv.Optional(CONF_DEADBAND, default=0.0): cv.positive_float,
+    cv.Optional(CONF_RELATIVE_DEADBAND, default="0%"): cv.percentage,
+    cv.Optional(CONF_MIN_INTERVAL, default="0s"): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_HEARTBEAT, default="10min"): cv.positive_time_period_milliseconds,
+})
+
 # requestsMap-backed data points (data-frames.hpp): configuring one of these
 # is what tells ToshibaLog to actively request it when active requests are
 # enabled -- see ToshibaLog::set_data_sensor()
@@ -71,6 +95,17 @@ STATUS_SENSOR_TYPES = {
     "zone2_target2": sensor.sensor_schema(unit_of_measurement=UNIT_CELSIUS, accuracy_decimals=0, device_class=DEVICE_CLASS_TEMPERATURE, state_class=STATE_CLASS_MEASUREMENT),
 }
 
+
+def _data_sensor_schema(key):
+    slow = key in DATA_SENSOR_SLOW_TYPES or key.endswith("_on_time")
+    return {
+        cv.Optional(CONF_MAX_AGE, default=DATA_SENSOR_SLOW_MAX_AGE if slow else DATA_SENSOR_MAX_AGE): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_PUBLISH, default={}): PUBLISH_SCHEMA,
+    }
+
+
+DATA_SENSOR_TYPES = {key: schema.extend(_data_sensor_schema(key)) for key, schema in DATA_SENSOR_TYPES.items()}
+
 ALL_SENSOR_TYPES = {**DATA_SENSOR_TYPES, **STATUS_SENSOR_TYPES}
 
 CONFIG_SCHEMA = cv.typed_schema(
@@ -90,6 +125,9 @@ async def to_code(config):
     sens = await sensor.new_sensor(config)
     type_key = config[CONF_TYPE]
     if type_key in DATA_SENSOR_TYPES:
-        cg.add(hub.set_data_sensor(type_key, sens))
+        cg.add(hub.set_data_sensor(type_key, sens, config[CONF_MAX_AGE]))
+        publish = config[CONF_PUBLISH]
+        cg.add(hub.set_data_publish_policy(type_key, publish[CONF_DEADBAND], publish[CONF_RELATIVE_DEADBAND],
+                                           publish[CONF_MIN_INTERVAL], publish[CONF_HEARTBEAT]))
     else:
         cg.add(hub.set_status_sensor(type_key, sens))
@@ -19,51 +19,65 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 #include "status-frames.hpp"
 
 StatusFrame::StatusFrame(FrameBuffer&& buffer, uint8_t length)
+    : EstiaFrame::EstiaFrame(std::move(buffer), length)
+    , error(check(FrameView(this->buffer))) {
+}
+
+StatusFrame::StatusFrame(const FrameBuffer& buffer, uint8_t length)
     : EstiaFrame::EstiaFrame(buffer, length)
-    , longFrame(length == FRAME_STATUS_LEN)
-    , error(0) {
-	error = checkFrame(longFrame ? FRAME_TYPE_STATUS : FRAME_TYPE_UPDATE, FRAME_DATA_TYPE_STATUS);
+    , error(check(FrameView(this->buffer))) {
 }
 
-StatusFrame::StatusFrame(FrameBuffer& buffer, uint8_t length)
-    : StatusFrame::StatusFrame(std::forward<FrameBuffer>(buffer), length) {
+StatusData StatusFrame::decode() {
+	return decode(FrameView(buffer));
 }
 
-StatusFrame::StatusFrame(ReadBuffer& buffer, uint8_t length)
-    : StatusFrame::StatusFrame(readBuffToFrameBuff(buffer), length) {
+uint8_t StatusFrame::check(const FrameView& frame) {
+	bool longFrame = frame.size() == FRAME_STATUS_LEN;
+	return frame.check(longFrame ? FRAME_TYPE_STATUS : FRAME_TYPE_UPDATE, FRAME_DATA_TYPE_STATUS);
 }
 
-StatusData StatusFrame::decode() {
+StatusData StatusFrame::decode(const FrameView& frame) {
+	uint8_t error = check(frame);
+	if (error != err_ok) {
+		StatusData data;
+		data.error = error;
+		return data;
+	}
+	return decodeUnchecked(frame);
+}
+
+// payload index 0 is frame offset 11
+StatusData StatusFrame::decodeUnchecked(const FrameView& frame) {
 	StatusData data;
-	data.error = error;
-	if (error == err_ok) {
-		data.extendedData = longFrame;
-		data.operationMode = (buffer.at(11) & 0xe0) >> 5;
-		data.cooling = (buffer.at(11) & 0xa1) == 0xa1;
-		data.heating = (buffer.at(11) & 0xc1) == 0xc1;
-		data.hotWater = (buffer.at(11) & 0x02) >> 1 == 0x01;
-		data.autoMode = (buffer.at(12) & 0x04) >> 2 == 0x01;
-		data.quietMode = (buffer.at(12) & 0x10) >> 4 == 0x01;
-		data.nightMode = (buffer.at(12) & 0x20) >> 5 == 0x01;
-		data.backupHeater = (buffer.at(13) & 0x01) >> 0 == 0x01;
-		data.coolingCMP = (buffer.at(13) & 0x02) >> 1 == 0x01 && data.operationMode == 0x05;
-		data.heatingCMP = (buffer.at(13) & 0x02) >> 1 == 0x01 && data.operationMode == 0x06;
-		data.hotWaterHeater = (buffer.at(13) & 0x04) >> 2 == 0x01;
-		data.hotWaterCMP = (buffer.at(13) & 0x08) >> 3 == 0x01;
-		data.pump1 = (buffer.at(13) & 0x10) >> 4 == 0x01;
-		data.hotWaterTarget = buffer.at(14) / 0x02 - 0x10;
-		data.zone1Target = buffer.at(15) / 0x02 - 0x10;
-		data.zone2Target = buffer.at(16) / 0x02 - 0x10;
-		if (longFrame) {
-			data.hotWaterTarget2 = buffer.at(17) / 0x02 - 0x10;
-			data.zone1Target2 = buffer.at(18) / 0x02 - 0x10;
-			data.zone2Target2 = buffer.at(19) / 0x02 - 0x10;
-			data.defrostInProgress = (buffer.at(21) & 0x02) == 0x02;
-			data.nightModeActive = (buffer.at(21) & 0x10) == 0x10;
-		} else {
-			data.defrostInProgress = (buffer.at(17) & 0x02) == 0x02;
-			data.nightModeActive = (buffer.at(17) & 0x10) == 0x10;
-		}
+	data.error = err_ok;
+	bool longFrame = frame.size() == FRAME_STATUS_LEN;
+	data.extendedData = longFrame;
+	data.operationMode = (frame.payloadUint8(0) & 0xe0) >> 5;
+	data.cooling = frame.payloadFlag(0, 0xa1);
+	data.heating = frame.payloadFlag(0, 0xc1);
+	data.hotWater = frame.payloadFlag(0, 0x02);
+	data.autoMode = frame.payloadFlag(1, 0x04);
+	data.quietMode = frame.payloadFlag(1, 0x10);
+	data.nightMode = frame.payloadFlag(1, 0x20);
+	data.backupHeater = frame.payloadFlag(2, 0x01);
+	data.coolingCMP = frame.payloadFlag(2, 0x02) && data.operationMode == 0x05;
+	data.heatingCMP = frame.payloadFlag(2, 0x02) && data.operationMode == 0x06;
+	data.hotWaterHeater = frame.payloadFlag(2, 0x04);
+	data.hotWaterCMP = frame.payloadFlag(2, 0x08);
+	data.pump1 = frame.payloadFlag(2, 0x10);
+	data.hotWaterTarget = frame.payloadUint8(3) / 0x02 - 0x10;
+	data.zone1Target = frame.payloadUint8(4) / 0x02 - 0x10;
+	data.zone2Target = frame.payloadUint8(5) / 0x02 - 0x10;
+	if (longFrame) {
+		data.hotWaterTarget2 = frame.payloadUint8(6) / 0x02 - 0x10;
+		data.zone1Target2 = frame.payloadUint8(7) / 0x02 - 0x10;
+		data.zone2Target2 = frame.payloadUint8(8) / 0x02 - 0x10;
+		data.defrostInProgress = frame.payloadFlag(10, 0x02);
+		data.nightModeActive = frame.payloadFlag(10, 0x10);
+	} else {
+		data.defrostInProgress = frame.payloadFlag(6, 0x02);
+		data.nightModeActive = frame.payloadFlag(6, 0x10);
 	}
 	return data;
 }
@@ -18,6 +18,7 @@ License along with this library; if not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include "frame-view.hpp"
 #include "frame.hpp"
 
 struct StatusData {
@@ -50,15 +51,14 @@ struct StatusData {
 #define STATUS_DST FRAME_SRC_DST_BROADCAST
 
 class StatusFrame : public EstiaFrame {
-  private:
-	bool longFrame;
-
   public:
 	StatusFrame(FrameBuffer&& buffer, uint8_t length);
-	StatusFrame(FrameBuffer& buffer, uint8_t length);
-	StatusFrame(ReadBuffer& buffer, uint8_t length);
+	StatusFrame(const FrameBuffer& buffer, uint8_t length);
 
 	uint8_t error;
 
 	StatusData decode();
+	static uint8_t check(const FrameView& frame);
+	static StatusData decode(const FrameView& frame);
+	static StatusData decodeUnchecked(const FrameView& frame);    // header and CRC already validated
 };
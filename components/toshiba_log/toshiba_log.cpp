@@ -1,8 +1,14 @@
 #include "estia-serial.h"
 #include "toshiba_log.h"
 #include "esphome/core/log.h"
+#ifdef USE_LOGGER
+#include "esphome/components/logger/logger.h"
+#endif
+#ifdef USE_API
+#include "esphome/components/api/api_server.h"
+#endif
+#include <Arduino.h>
 #include <cmath>
-#include <utility>
 
 namespace toshiba_log {
 
@@ -10,9 +16,35 @@ static const char *TAG = "toshiba_log";
 
 void ToshibaLog::setup() {
   ESP_LOGI(TAG, "UART logger started");
-  estiaSerial.reset(new EstiaSerial(*this));
+  estiaSerial.reset(new EstiaSerial(uart_adapter_, clock_));
+  setup_capture_();
+  setup_scheduler_();
+#ifdef TOSHIBA_LOG_CRC_BENCHMARK
+  benchmarkCrc();
+#endif
 }
 
+#ifdef TOSHIBA_LOG_CRC_BENCHMARK
+// on-target counterpart of estia-bench's crc16/* cases, enable with
+// build_flags: -DTOSHIBA_LOG_CRC_BENCHMARK
+void ToshibaLog::benchmarkCrc() {
+  static const uint32_t rounds = 2000;
+  uint8_t frame[FRAME_MAX_LEN];
+  for (uint8_t idx = 0; idx < FRAME_MAX_LEN; idx++) { frame[idx] = idx * 37; }
+
+  auto run = [&](const char* name, uint16_t (*kernel)(const uint8_t*, size_t, uint16_t)) {
+    volatile uint16_t sink = 0;
+    uint32_t start = esphome::micros();
+    for (uint32_t round = 0; round < rounds; round++) { sink = kernel(frame, FRAME_MAX_LEN, CRC16_INIT); }
+    uint32_t elapsed = esphome::micros() - start;
+    ESP_LOGI(TAG, "crc16 %-8s %.1f ns/byte (0x%04X)", name, elapsed * 1000.0f / (rounds * FRAME_MAX_LEN), (uint16_t) sink);
+  };
+  run("bitwise", Crc16::computeBitwise);
+  run("nibble", Crc16::computeNibble);
+  run("table", Crc16::computeTable);
+}
+#endif
+
 void ToshibaLog::loop() {
   /* 
   while (available()) {
@@ -24,52 +56,133 @@ void ToshibaLog::loop() {
 
   switch (estiaSerial->sniffer()) {
     case EstiaSerial::sniff_frame_pending:
-      Serial.println(EstiaFrame::stringify(estiaSerial->getSniffedFrame()));
+      dump_frame_(estiaSerial->getSniffedFrame());
       if (estiaSerial->frameAck != 0) {
-        ESP_LOGD(TAG, "frame 0x%04X acked\n", estiaSerial->getAck());
+        binary_log_.logAck(millis(), estiaSerial->getAck());
       } else if (estiaSerial->newStatusData) {
         StatusData data = estiaSerial->getStatusData();
-        printStatusData(data);
+        binary_log_.logStatus(millis(), data);
         publish_status_entities_(data);
-        // request sensors data after extended status data received (every 30s)
-        if (active_requests_enabled_ && data.extendedData) {
-          if (data.pump1 ||                                                      // when pump1 is on every 30s
-              millis() - requestDataTimer >= requestDataOffInterval - 1000) {    // when pump1 is off every 5min
-            requestDataTimer = millis();
-            // request exactly the data points that have a configured sensor: entry
-            // (see set_data_sensor()) -- no separate list to keep in sync, and if
-            // none are configured we deliberately don't fall back to a default list
-            DataToRequest wanted;
-            for (auto& kv : data_sensors_) { wanted.push_back(kv.first); }
-            if (!wanted.empty()) {
-              estiaSerial->requestSensorsData(std::move(wanted));
-            }
-          }
+        // requests start once the master is talking, while pump1 is off
+        // nothing needs refreshing more often than every 5min
+        if (data.error == StatusFrame::err_ok && data.extendedData) {
+          bus_seen_ = true;
+          pump_running_ = data.pump1;
         }
       }
+      erase_capture_();
       break;
     case EstiaSerial::sniff_idle:
       // to avoid data collisions write and request data here
       if (estiaSerial->newSensorsData) {
         publish_data_sensors_();
       }
+      if (active_requests_enabled_ && bus_seen_) { schedule_requests_(); }
+      drain_log_();
+      if (capture_) { capture_->drain(); }
       break;
     }
 }
 
-void ToshibaLog::publish_data_sensors_() {
-  for (auto& sensor : estiaSerial->getSensorsData()) {
-    auto it = data_sensors_.find(sensor.first);
-    if (it == data_sensors_.end()) { continue; }
-    // data is error code, skip multiplier
-    if (sensor.second.value <= EstiaSerial::err_not_exist) {
-      it->second->publish_state(NAN);
-    } else {
-      it->second->publish_state(sensor.second.value * sensor.second.multiplier);
+void ToshibaLog::setup_capture_() {
+  if (capture_mode_ == CAPTURE_OFF) { return; }
+  capture_.reset(new BusCapture());
+  estiaSerial->setCapture(capture_.get());
+  if (capture_mode_ != CAPTURE_FLASH) { return; }
+#ifdef USE_ESP32
+  if (capture_sink_.begin(capture_partition_.c_str())) {
+    if (capture_compress_) {
+      capture_codec_.reset(new CaptureCodec());
+      capture_sink_.setCodec(capture_codec_.get());
     }
+    capture_->setSink(&capture_sink_);
+    ESP_LOGI(TAG, "Capturing bus to partition '%s'", capture_partition_.c_str());
+    return;
+  }
+  ESP_LOGW(TAG, "No usable capture partition '%s', capturing to RAM only", capture_partition_.c_str());
+#else
+  ESP_LOGW(TAG, "Flash capture needs an ESP32, capturing to RAM only");
+#endif
+}
+
+// a flash sector erase stalls the loop: do it right after a frame, away from
+// the idle slot requests go out in, with no request waiting for its response
+// and no master frame due before it's done
+void ToshibaLog::erase_capture_() {
+#ifdef USE_ESP32
+  if (!capture_sink_.erase_pending() || scheduled_ != SCHEDULER_NONE) { return; }
+  if (!estiaSerial->getBusTiming().clearFor(millis(), CAPTURE_ERASE_TIME)) { return; }
+  capture_sink_.erase();
+#endif
+}
+
+// request exactly the data points that have a configured sensor: entry (see
+// set_data_sensor()) -- no separate list to keep in sync, and if none are
+// configured we deliberately don't fall back to a default list
+void ToshibaLog::setup_scheduler_() {
+  for (uint8_t ordinal = 0; ordinal < SensorRegistry::size(); ordinal++) {
+    if (data_sensors_[ordinal] == nullptr) { continue; }
+    scheduler_.add(SensorRegistry::code(ordinal), data_max_age_[ordinal]);
+  }
+}
+
+// one request at a time, the free bus slot goes to the stalest sensor
+void ToshibaLog::schedule_requests_() {
+  if (scheduled_ == SCHEDULER_NONE) {
+    scheduled_ = scheduler_.next(millis(), pump_running_ ? 0 : requestDataOffInterval);
+    if (scheduled_ == SCHEDULER_NONE) { return; }
+    scheduler_.requested(scheduled_, millis());
+  }
+  uint8_t code = scheduler_.sensor(scheduled_).code;
+  int16_t value = estiaSerial->requestData(code);
+  if (value == EstiaSerial::err_pending) { return; }
+
+  // an empty response is an answer too, the unit doesn't have that sensor;
+  // once the registry gave up on it (see EstiaSerial::saveSyncData()) a failing
+  // sensor publishes NAN and waits for its max_age like an answered one
+  uint8_t ordinal = SensorRegistry::ordinal(code);
+  bool answered = value > EstiaSerial::err_not_exist || value == EstiaSerial::err_data_empty;
+  bool failed = estiaSerial->getSensorRegistry()[ordinal].status == sensor_failed;
+  scheduler_.completed(scheduled_, millis(), answered || failed);
+  if (answered || failed) { publish_data_sensor_(ordinal); }
+  scheduled_ = SCHEDULER_NONE;
+}
+
+void ToshibaLog::dump_frame_(const SniffedFrame& frame) {
+  switch (frame_dump_) {
+    case FRAME_DUMP_OFF:
+      return;
+    case FRAME_DUMP_ERRORS:
+      if (frame.frameClass().valid()) { return; }
+      break;
+    case FRAME_DUMP_SAMPLED:
+      if (++frame_dump_counter_ < frame_dump_sample_) { return; }
+      frame_dump_counter_ = 0;
+      break;
+    case FRAME_DUMP_ALL:
+      break;
+  }
+  binary_log_.logFrame(millis(), frame->data(), frame->size());
+}
+
+void ToshibaLog::publish_data_sensors_() {
+  SensorRegistry& registry = estiaSerial->getSensorsData();
+  for (uint8_t ordinal = 0; ordinal < SensorRegistry::size(); ordinal++) {
+    if (registry[ordinal].status != sensor_unset) { publish_data_sensor_(ordinal); }
   }
 }
 
+// unchanged values and changes inside the deadband never reach publish_state()
+void ToshibaLog::publish_data_sensor_(uint8_t ordinal) {
+  esphome::sensor::Sensor* sensor = data_sensors_[ordinal];
+  if (sensor == nullptr) { return; }
+  const SensorSlot& slot = estiaSerial->getSensorRegistry()[ordinal];
+  // data is error code, skip multiplier
+  float state = slot.status == sensor_valid ? slot.value * slot.multiplier : NAN;
+  if (!publish_filters_[ordinal].publish(state, millis())) { return; }
+  sensor->publish_state(state);
+}
+
 void ToshibaLog::publish_status_entities_(StatusData& data) {
   if (data.error != StatusFrame::err_ok) { return; }
 
@@ -111,34 +224,35 @@ void ToshibaLog::publish_status_entities_(StatusData& data) {
   }
 }
 
-void ToshibaLog::printStatusData(StatusData& data) {
-	if (data.error == StatusFrame::err_ok) {
-		ESP_LOGD(TAG, "operationMode:     %s\n", data.operationMode == 0x06 ? "heating" : "cooling");
-		ESP_LOGD(TAG, "cooling:           %s\n", data.cooling ? "on" : "off");
-		ESP_LOGD(TAG, "heating:           %s\n", data.heating ? "on" : "off");
-		ESP_LOGD(TAG, "hotWater:          %s\n", data.hotWater ? "on" : "off");
-		ESP_LOGD(TAG, "autoMode:          %s\n", data.autoMode ? "on" : "off");
-		ESP_LOGD(TAG, "quietMode:         %s\n", data.quietMode ? "on" : "off");
-		ESP_LOGD(TAG, "nightMode:         %s\n", data.nightMode ? "on" : "off");
-		ESP_LOGD(TAG, "backupHeater:      %s\n", data.backupHeater ? "on" : "off");
-		ESP_LOGD(TAG, "coolingCMP:        %s\n", data.coolingCMP ? "on" : "off");
-		ESP_LOGD(TAG, "heatingCMP:        %s\n", data.heatingCMP ? "on" : "off");
-		ESP_LOGD(TAG, "hotWaterHeater:    %s\n", data.hotWaterHeater ? "on" : "off");
-		ESP_LOGD(TAG, "hotWaterCMP:       %s\n", data.hotWaterCMP ? "on" : "off");
-		ESP_LOGD(TAG, "pump1:             %s\n", data.pump1 ? "on" : "off");
-		ESP_LOGD(TAG, "hotWaterTarget:    %u\n", data.hotWaterTarget);
-		ESP_LOGD(TAG, "zone1Target:       %u\n", data.zone1Target);
-		ESP_LOGD(TAG, "zone2Target:       %u\n", data.zone2Target);
-		if (data.extendedData) {
-			ESP_LOGD(TAG, "hotWaterTarget2:   %u\n", data.hotWaterTarget2);
-			ESP_LOGD(TAG, "zone1Target2:      %u\n", data.zone1Target2);
-			ESP_LOGD(TAG, "zone2Target2:      %u\n", data.zone2Target2);
-		}
-		ESP_LOGD(TAG, "defrostInProgress: %s\n", data.defrostInProgress ? "true" : "false");
-		ESP_LOGD(TAG, "nightModeActive:   %s\n", data.nightModeActive ? "true" : "false");
-		ESP_LOGD(TAG, "extendedData:      %s\n", data.extendedData ? "true" : "false");
-	}
-	ESP_LOGD(TAG, "error:             %u\n", data.error);
+// one record per idle loop; below debug level nobody reads the records, the
+// ring fills up and logging costs a failed reserve
+// records are only formatted while someone can see the line: the runtime
+// log level lets DEBUG through and an API client (Home Assistant, `esphome
+// logs`) is connected, or without the API, the serial logger is on. Otherwise
+// they stay in the ring, which keeps the most recent ones for get_binary_log()
+bool ToshibaLog::log_consumer_attached_() const {
+#ifdef USE_LOGGER
+  esphome::logger::Logger* logger = esphome::logger::global_logger;
+  if (logger == nullptr || logger->level_for(TAG) < ESPHOME_LOG_LEVEL_DEBUG) { return false; }
+#ifdef USE_API
+  return esphome::api::global_api_server != nullptr && esphome::api::global_api_server->is_connected();
+#else
+  return logger->get_baud_rate() > 0;
+#endif
+#else
+  return false;
+#endif
+}
+
+void ToshibaLog::drain_log_() {
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG
+  if (!log_consumer_attached_()) { return; }
+  LogRecord record;
+  if (!binary_log_.pop(record)) { return; }
+  char line[BINARY_LOG_LINE_SIZE];
+  record.format(line, sizeof(line));
+  ESP_LOGD(TAG, "%s", line);
+#endif
 }
 
 }  // to namespace toshiba_log
\ No newline at end of file
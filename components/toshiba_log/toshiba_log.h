@@ -4,12 +4,32 @@
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/text_sensor/text_sensor.h"
 #include "esphome/components/binary_sensor/binary_sensor.h"
+#include "binary-log.hpp"
+#include "capture-codec.hpp"
 #include "estia-serial.h"
+#include "publish-filter.hpp"
+#include "request-scheduler.hpp"
+#include "toshiba_log_hal.h"
 #include <map>
 #include <string>
 
 namespace toshiba_log {
 
+// raw frame hex dump on Serial
+enum FrameDump : uint8_t {
+  FRAME_DUMP_OFF,
+  FRAME_DUMP_ERRORS,     // frames still failing the CRC after FrameFixer
+  FRAME_DUMP_SAMPLED,    // every Nth frame
+  FRAME_DUMP_ALL,
+};
+
+// timestamped bus capture, see bus-capture.hpp for the record format
+enum CaptureMode : uint8_t {
+  CAPTURE_OFF,
+  CAPTURE_RAM,      // most recent traffic in a RAM ring, see get_capture()
+  CAPTURE_FLASH,    // RAM ring drained to a data partition (ESP32 only)
+};
+
 class ToshibaLog : public esphome::Component,
                      public esphome::uart::UARTDevice {
 
@@ -19,29 +39,87 @@ class ToshibaLog : public esphome::Component,
     void loop() override;
 
     // requestsMap-backed numeric sensors; being registered here is what marks
-    // a data point as "actively request this" when active requests are enabled
-    void set_data_sensor(const std::string& type, esphome::sensor::Sensor* sens) { data_sensors_[type] = sens; }
+    // a data point as "actively request this" when active requests are enabled,
+    // `max_age` is how stale its value may get before it is requested again
+    void set_data_sensor(const std::string& type, esphome::sensor::Sensor* sens, uint32_t max_age = SCHEDULER_DEFAULT_MAX_AGE) {
+      uint8_t ordinal = SensorRegistry::ordinal(type);
+      if (ordinal == SENSOR_NONE) { return; }
+      data_sensors_[ordinal] = sens;
+      data_max_age_[ordinal] = max_age;
+    }
+    // when a new value of a data sensor is worth a publish_state(), see PublishFilter
+    void set_data_publish_policy(const std::string& type, float deadband, float relative_deadband,
+                                 uint32_t min_interval, uint32_t heartbeat) {
+      uint8_t ordinal = SensorRegistry::ordinal(type);
+      if (ordinal == SENSOR_NONE) { return; }
+      publish_filters_[ordinal].setPolicy({deadband, relative_deadband, min_interval, heartbeat});
+    }
     // StatusData numeric target fields (never actively requested, only passively decoded)
     void set_status_sensor(const std::string& type, esphome::sensor::Sensor* sens) { status_sensors_[type] = sens; }
     void set_status_text_sensor(const std::string& type, esphome::text_sensor::TextSensor* sens) { status_text_sensors_[type] = sens; }
     void set_status_binary_sensor(const std::string& type, esphome::binary_sensor::BinarySensor* sens) { status_binary_sensors_[type] = sens; }
     void set_active_requests_enabled(bool enabled) { active_requests_enabled_ = enabled; }
+    // also callable from lambdas to change the dump mode at runtime
+    void set_frame_dump(FrameDump mode, uint16_t sample_every = 1) {
+      frame_dump_ = mode;
+      frame_dump_sample_ = sample_every > 0 ? sample_every : 1;
+      frame_dump_counter_ = 0;
+    }
+    void set_capture(CaptureMode mode, const std::string& partition, bool compress = true) {
+      capture_mode_ = mode;
+      capture_partition_ = partition;
+      capture_compress_ = compress;
+    }
+    BusCapture* get_capture() { return capture_.get(); }
+    // most recent status, ack and frame dump records, also when no log client is connected
+    BinaryLog* get_binary_log() { return &binary_log_; }
 
   private:
-    void printStatusData(StatusData& data);
+#ifdef TOSHIBA_LOG_CRC_BENCHMARK
+    void benchmarkCrc();
+#endif
+    void dump_frame_(const SniffedFrame& frame);
+    bool log_consumer_attached_() const;
+    void drain_log_();
+    void setup_capture_();
+    void erase_capture_();
+    void setup_scheduler_();
+    void schedule_requests_();
     void publish_status_entities_(StatusData& data);
     void publish_data_sensors_();
+    void publish_data_sensor_(uint8_t ordinal);
 
     u_long requestDataOffInterval = 300000;    // data update interval when heat pump is doing nothing
-    u_long requestDataTimer = requestDataOffInterval;
     bool requestData = false;
+    UartDeviceAdapter uart_adapter_{this};
+    EsphomeClock clock_;
     std::unique_ptr<EstiaSerial> estiaSerial;
+    // status, ack and frame dump diagnostics, formatted only when drained by a log consumer
+    BinaryLog binary_log_;
+    std::unique_ptr<BusCapture> capture_;
+#ifdef USE_ESP32
+    PartitionCaptureSink capture_sink_;
+    std::unique_ptr<CaptureCodec> capture_codec_;
+#endif
 
-    std::map<std::string, esphome::sensor::Sensor*> data_sensors_;
+    // by SensorRegistry ordinal, like EstiaSerial's registry
+    esphome::sensor::Sensor* data_sensors_[SENSOR_REGISTRY_SIZE] = {};
+    uint32_t data_max_age_[SENSOR_REGISTRY_SIZE] = {};
+    PublishFilter publish_filters_[SENSOR_REGISTRY_SIZE];
+    RequestScheduler scheduler_;
+    int16_t scheduled_ = SCHEDULER_NONE;    // request in flight
+    bool bus_seen_ = false;                  // extended status received, master is talking
+    bool pump_running_ = false;
     std::map<std::string, esphome::sensor::Sensor*> status_sensors_;
     std::map<std::string, esphome::text_sensor::TextSensor*> status_text_sensors_;
     std::map<std::string, esphome::binary_sensor::BinarySensor*> status_binary_sensors_;
     bool active_requests_enabled_ = false;
+    FrameDump frame_dump_ = FRAME_DUMP_ALL;
+    uint16_t frame_dump_sample_ = 1;
+    uint16_t frame_dump_counter_ = 0;
+    CaptureMode capture_mode_ = CAPTURE_OFF;
+    std::string capture_partition_ = "capture";
+    bool capture_compress_ = true;
 };
 
 }  // namespace toshiba_log
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+#include "esphome/core/hal.h"
+#include "esphome/components/uart/uart.h"
+#include "bus-capture.hpp"
+#include "estia-hal.hpp"
+#ifdef USE_ESP32
+#include <esp_partition.h>
+#endif
+
+namespace toshiba_log {
+
+// EstiaUart over the component's own esphome::uart::UARTDevice
+class UartDeviceAdapter : public EstiaUart {
+  public:
+    explicit UartDeviceAdapter(esphome::uart::UARTDevice* device) : device_(device) {}
+
+    int available() override { return device_->available(); }
+    uint8_t read() override { return device_->read(); }
+    void write(const uint8_t* data, size_t len) override { device_->write_array(data, len); }
+    void flush() override { device_->flush(); }
+
+  private:
+    esphome::uart::UARTDevice* device_;
+};
+
+// EstiaClock over the ESPHome HAL millis()/micros()/delay()
+class EsphomeClock : public EstiaClock {
+  public:
+    uint32_t millis() override { return esphome::millis(); }
+    uint32_t micros() override { return esphome::micros(); }
+    void delay(uint32_t ms) override { esphome::delay(ms); }
+};
+
+#ifdef USE_ESP32
+#define CAPTURE_ERASE_TIME 50    // ms, typical 4 KiB flash sector erase
+
+// CaptureSink over a raw data partition; wraps around and keeps the sector
+// after the one being written erased, so a reader finds the oldest data
+// right after the erased sector. An erase stalls the CPU, so it isn't done
+// while appending: a sector is only started once the one after it was
+// erased through erase(), which the owner calls when the bus allows it, and
+// records wait in the RAM ring until then
+class PartitionCaptureSink : public CaptureSink {
+  public:
+    // resumes after the last boot's data: writing starts at the erased sector
+    bool begin(const char* label) {
+      partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+      if (partition_ == nullptr || partition_->size < 2 * BUS_CAPTURE_SECTOR_SIZE) {
+        partition_ = nullptr;
+        return false;
+      }
+      size_t sectors = size_() / BUS_CAPTURE_SECTOR_SIZE;
+      for (size_t idx = 0; idx < sectors; idx++) {
+        if (!sector_erased_(idx) || sector_erased_((idx + sectors - 1) % sectors)) { continue; }
+        head_ = idx * BUS_CAPTURE_SECTOR_SIZE;
+        return true;
+      }
+      // fresh partition, or one without an erased sector: start over at 0
+      head_ = 0;
+      return sector_erased_(0) || esp_partition_erase_range(partition_, 0, BUS_CAPTURE_SECTOR_SIZE) == ESP_OK;
+    }
+    bool erase_pending() const { return partition_ && pending_ != erased_sector_; }
+    // blocks for CAPTURE_ERASE_TIME
+    void erase() {
+      if (!erase_pending()) { return; }
+      if (esp_partition_erase_range(partition_, pending_, BUS_CAPTURE_SECTOR_SIZE) == ESP_OK) { erased_sector_ = pending_; }
+    }
+
+  protected:
+    bool write(size_t offset, const uint8_t* data, size_t len) override {
+      return partition_ && esp_partition_write(partition_, (head_ + offset) % size_(), data, len) == ESP_OK;
+    }
+    bool beginSector(size_t offset) override {
+      if (!partition_) { return false; }
+      pending_ = (head_ + offset + BUS_CAPTURE_SECTOR_SIZE) % size_();
+      return pending_ == erased_sector_;
+    }
+
+  private:
+    size_t size_() const { return partition_->size - partition_->size % BUS_CAPTURE_SECTOR_SIZE; }
+    // same test as CaptureReader: the length byte of the first record is erased flash
+    bool sector_erased_(size_t sector) const {
+      uint8_t length = 0;
+      esp_partition_read(partition_, sector * BUS_CAPTURE_SECTOR_SIZE + 5, &length, 1);
+      return length == BUS_CAPTURE_PADDING;
+    }
+
+    const esp_partition_t* partition_ = nullptr;
+    size_t head_ = 0;                    // partition offset of stream offset 0
+    size_t pending_ = SIZE_MAX;          // sector the next beginSector() needs erased
+    size_t erased_sector_ = SIZE_MAX;    // last sector erase() cleared
+};
+#endif
+
+}  // namespace toshiba_log
@@ -0,0 +1,137 @@
+/*
+bench.cpp - minimal micro-benchmark harness for the estia core
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "bench.hpp"
+#include <map>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+std::atomic<uint64_t> benchAllocations(0);
+
+void* operator new(size_t size) {
+	benchAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = malloc(size ? size : 1)) { return ptr; }
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	free(ptr);
+}
+
+BenchRunner::BenchRunner(int argc, char** argv)
+    : filter()
+    , minTimeMs(200)
+    , jsonPath()
+    , baselinePath()
+    , tolerance(10)
+    , results() {
+	for (int idx = 1; idx + 1 < argc; idx += 2) {
+		if (strcmp(argv[idx], "--filter") == 0) {
+			filter = argv[idx + 1];
+		} else if (strcmp(argv[idx], "--min-time") == 0) {
+			minTimeMs = atof(argv[idx + 1]);
+		} else if (strcmp(argv[idx], "--json") == 0) {
+			jsonPath = argv[idx + 1];
+		} else if (strcmp(argv[idx], "--baseline") == 0) {
+			baselinePath = argv[idx + 1];
+		} else if (strcmp(argv[idx], "--tolerance") == 0) {
+			tolerance = atof(argv[idx + 1]);
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[idx]);
+		}
+	}
+	printf("%-40s %12s %10s %10s %10s\n", "benchmark", "iterations", "ns/op", "ns/byte", "allocs/op");
+}
+
+bool BenchRunner::selected(const char* name) const {
+	return filter.empty() || strstr(name, filter.c_str()) != nullptr;
+}
+
+void BenchRunner::record(const char* name, uint64_t iterations, size_t bytesPerOp, double ns, uint64_t allocs) {
+	BenchResult result;
+	result.name = name;
+	result.iterations = iterations;
+	result.bytesPerOp = bytesPerOp;
+	result.nsPerOp = ns / iterations;
+	result.nsPerByte = bytesPerOp ? result.nsPerOp / bytesPerOp : 0;
+	result.allocsPerOp = static_cast<double>(allocs) / iterations;
+	printf("%-40s %12llu %10.1f %10.2f %10.2f\n", name, static_cast<unsigned long long>(iterations), result.nsPerOp,
+	       result.nsPerByte, result.allocsPerOp);
+	fflush(stdout);
+	results.push_back(result);
+}
+
+// one result object per line, so the baseline can be read back with sscanf
+int BenchRunner::finish() {
+	if (!jsonPath.empty()) {
+		FILE* json = fopen(jsonPath.c_str(), "w");
+		if (!json) {
+			perror(jsonPath.c_str());
+			return 1;
+		}
+		fprintf(json, "{\"benchmarks\": [\n");
+		for (size_t idx = 0; idx < results.size(); idx++) {
+			const BenchResult& result = results.at(idx);
+			fprintf(json, "{\"name\": \"%s\", \"iterations\": %llu, \"bytes_per_op\": %zu, \"ns_per_op\": %.3f, \"ns_per_byte\": %.4f, \"allocs_per_op\": %.3f}%s\n",
+			        result.name.c_str(), static_cast<unsigned long long>(result.iterations), result.bytesPerOp, result.nsPerOp,
+			        result.nsPerByte, result.allocsPerOp, idx + 1 < results.size() ? "," : "");
+		}
+		fprintf(json, "]}\n");
+		fclose(json);
+	}
+	if (baselinePath.empty()) { return 0; }
+
+	FILE* baseline = fopen(baselinePath.c_str(), "r");
+	if (!baseline) {
+		perror(baselinePath.c_str());
+		return 1;
+	}
+	std::map<std::string, std::pair<double, double>> baselineResults;
+	char line[512];
+	while (fgets(line, sizeof(line), baseline)) {
+		char name[128];
+		unsigned long long iterations;
+		size_t bytesPerOp;
+		double nsPerOp, nsPerByte, allocsPerOp;
+		if (sscanf(line, "{\"name\": \"%127[^\"]\", \"iterations\": %llu, \"bytes_per_op\": %zu, \"ns_per_op\": %lf, \"ns_per_byte\": %lf, \"allocs_per_op\": %lf",
+		           name, &iterations, &bytesPerOp, &nsPerOp, &nsPerByte, &allocsPerOp)
+		    == 6) {
+			baselineResults[name] = {nsPerOp, allocsPerOp};
+		}
+	}
+	fclose(baseline);
+
+	int regressions = 0;
+	for (auto& result : results) {
+		auto it = baselineResults.find(result.name);
+		if (it == baselineResults.end()) { continue; }
+		double slower = (result.nsPerOp / it->second.first - 1) * 100;
+		if (slower > tolerance || result.allocsPerOp > it->second.second) {
+			printf("REGRESSION %s: %.1f ns/op (baseline %.1f, %+.1f %%), %.2f allocs/op (baseline %.2f)\n", result.name.c_str(),
+			       result.nsPerOp, it->second.first, slower, result.allocsPerOp, it->second.second);
+			regressions++;
+		}
+	}
+	return regressions ? 2 : 0;
+}
@@ -0,0 +1,131 @@
+/*
+bench.hpp - minimal micro-benchmark harness for the estia core
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+* Heap allocations made by the benchmark process, counted by the global
+* `operator new` replacement in `bench.cpp`.
+*/
+extern std::atomic<uint64_t> benchAllocations;
+
+template <typename T>
+inline void doNotOptimize(const T& value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult {
+	std::string name;
+	uint64_t iterations;
+	size_t bytesPerOp;
+	double nsPerOp;
+	double nsPerByte;
+	double allocsPerOp;
+};
+
+/**
+* Runs registered benchmarks, prints a table and optionally writes JSON
+* results and compares them against a baseline.
+*
+* Usage: <bench> [--filter SUBSTR] [--min-time MS] [--json FILE]
+*                [--baseline FILE] [--tolerance PERCENT]
+*/
+class BenchRunner {
+  private:
+	std::string filter;
+	double minTimeMs;
+	std::string jsonPath;
+	std::string baselinePath;
+	double tolerance;
+	std::vector<BenchResult> results;
+
+	void record(const char* name, uint64_t iterations, size_t bytesPerOp, double ns, uint64_t allocs);
+
+  public:
+	BenchRunner(int argc, char** argv);
+
+	bool selected(const char* name) const;    // skip expensive setup of filtered out groups
+
+	/**
+	* @param name benchmark name, `group/case`
+	* @param bytesPerOp input bytes processed by one call of `op`
+	* @param op benchmarked operation
+	* @param reset optional untimed setup run before every call of `op`
+	*/
+	template <typename Op>
+	void run(const char* name, size_t bytesPerOp, Op&& op);
+	template <typename Op, typename Reset>
+	void run(const char* name, size_t bytesPerOp, Op&& op, Reset&& reset);
+
+	int finish();
+};
+
+// without setup the whole batch is timed at once, keeping clock overhead out of short ops
+template <typename Op>
+void BenchRunner::run(const char* name, size_t bytesPerOp, Op&& op) {
+	if (!selected(name)) { return; }
+
+	using Clock = std::chrono::steady_clock;
+	uint64_t iterations = 1;
+	while (true) {
+		uint64_t allocsBefore = benchAllocations.load(std::memory_order_relaxed);
+		auto start = Clock::now();
+		for (uint64_t idx = 0; idx < iterations; idx++) {
+			op();
+		}
+		double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+		uint64_t allocs = benchAllocations.load(std::memory_order_relaxed) - allocsBefore;
+		if (ns >= minTimeMs * 1e6 || iterations >= (1ULL << 32)) {
+			record(name, iterations, bytesPerOp, ns, allocs);
+			return;
+		}
+		iterations *= ns < minTimeMs * 1e5 ? 10 : 2;
+	}
+}
+
+template <typename Op, typename Reset>
+void BenchRunner::run(const char* name, size_t bytesPerOp, Op&& op, Reset&& reset) {
+	if (!selected(name)) { return; }
+
+	using Clock = std::chrono::steady_clock;
+	uint64_t iterations = 1;
+	while (true) {
+		double ns = 0;
+		uint64_t allocs = 0;
+		for (uint64_t idx = 0; idx < iterations; idx++) {
+			reset();
+			uint64_t allocsBefore = benchAllocations.load(std::memory_order_relaxed);
+			auto start = Clock::now();
+			op();
+			ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+			allocs += benchAllocations.load(std::memory_order_relaxed) - allocsBefore;
+		}
+		if (ns >= minTimeMs * 1e6 || iterations >= (1ULL << 32)) {
+			record(name, iterations, bytesPerOp, ns, allocs);
+			return;
+		}
+		iterations *= ns < minTimeMs * 1e5 ? 10 : 2;
+	}
+}
@@ -0,0 +1,507 @@
+/*
+estia-bench.cpp - micro-benchmarks for the frame hot paths
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "bench.hpp"
+#include "binary-log.hpp"
+#include "bus-capture.hpp"
+#include "capture-codec.hpp"
+#include "estia-bus-sim.hpp"
+#include "estia-serial.hpp"
+#include "host-capture.hpp"
+#include "host-hal.hpp"
+#include "sim-clock.hpp"
+#include <algorithm>
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef ESTIA_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// access to the EstiaSerial internals that make up the RX pipeline
+class EstiaSerialBench {
+  public:
+	static bool read(EstiaSerial& estiaSerial) { return estiaSerial.read(estiaSerial.snifferBuffer); }
+	static void syncSnifferBuffer(EstiaSerial& estiaSerial) { estiaSerial.syncSnifferBuffer(true); }
+	static ReadBuffer& snifferBuffer(EstiaSerial& estiaSerial) { return estiaSerial.snifferBuffer; }
+	static SniffedFrames& sniffedFrames(EstiaSerial& estiaSerial) { return estiaSerial.sniffedFrames; }
+	// one queued sweep answered without touching the bus
+	static void answerSweep(EstiaSerial& estiaSerial, const FrameView& response) {
+		while (!estiaSerial.requestQueue.empty()) {
+			estiaSerial.requestSent = true;
+			estiaSerial.decodeResponse(response, EstiaFrame::err_ok);
+		}
+	}
+};
+
+// EstiaFrame::crc16 before the table-driven engine, kept as the reference
+// https://gist.github.com/aurelj/270bb8af82f65fa645c1?permalink_comment_id=2884584#gistcomment-2884584
+static uint16_t crc16Legacy(const uint8_t* data, size_t len) {
+	uint16_t crc = 0xffff;
+	uint8_t L;
+	uint8_t t;
+	if (!data || len <= 0) { return crc; }
+	while (len--) {
+		crc ^= *data++;
+		L = crc ^ (crc << 4);
+		t = (L << 3) | (L >> 5);
+		L ^= (t & 0x07);
+		t = (t & 0xf8) ^ (((t << 1) | (t >> 7)) & 0x0f) ^ (uint8_t)(crc >> 8);
+		crc = (L << 8) | t;
+	}
+	return crc;
+}
+
+static FrameBuffer statusFrame() {
+	FrameBuffer payload = {0xc3, 0x00, 0x12, 0x84, 0x66, 0x66, 0x84, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+	return EstiaBusSim::makeFrame(FRAME_TYPE_STATUS, STATUS_SRC, STATUS_DST, FRAME_DATA_TYPE_STATUS, payload);
+}
+
+static FrameBuffer dataResFrame() {
+	FrameBuffer payload = {0x00, 0x80, 0x00, 0x2c, 0x00, 0x23};
+	return EstiaBusSim::makeFrame(FRAME_TYPE_RES_DATA, RES_DATA_SRC, RES_DATA_DST, FRAME_DATA_TYPE_DATA_RESPONSE, payload);
+}
+
+static FrameBuffer heartbeatFrame() {
+	return EstiaBusSim::makeFrame(FRAME_TYPE_CTRL_FRAME, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_BROADCAST, FRAME_DATA_TYPE_HEARTBEAT, {});
+}
+
+// typical bus traffic: heartbeats, a status broadcast and some data responses
+static FrameBuffer busStream() {
+	FrameBuffer stream;
+	for (uint8_t idx = 0; idx < 8; idx++) {
+		FrameBuffer frame = idx == 0 ? statusFrame() : idx % 2 ? heartbeatFrame() : dataResFrame();
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+	return stream;
+}
+
+// whole sniffer pipeline until idle, the way the fuzz target runs it
+static void sniff(EstiaSerial& estiaSerial, BufferUart& uart, SimClock& clock) {
+	while (estiaSerial.sniffer() != EstiaSerial::sniff_idle) {
+		if (!estiaSerial.getSniffedFrame().empty()) { continue; }
+		clock.delay(uart.available() ? 1 : ESTIA_SERIAL_FRAME_GAP);
+	}
+}
+
+// an hour of simulated bus traffic with sensor cycles, as the capture option records it
+static std::vector<CaptureRecord> simulatedCapture() {
+	SimBusConfig config;
+	config.corruptRate = 0.001;
+	config.collisionRate = 0.01;
+	SimClock clock;
+	EstiaBusSim bus(clock, config);
+	EstiaSerial estiaSerial(bus, clock);
+	BusCapture capture;
+	BufferCaptureSink sink;
+	capture.setSink(&sink);
+	estiaSerial.setCapture(&capture);
+	while (clock.millis() < 3600 * 1000) {
+		if (estiaSerial.sniffer() == EstiaSerial::sniff_frame_pending) {
+			estiaSerial.getSniffedFrame();
+			if (estiaSerial.newStatusData && estiaSerial.getStatusData().extendedData) {
+				estiaSerial.requestSensorsData(SensorRegistry::defaults(), true);
+			}
+		}
+		while (capture.drain()) {}
+		clock.delay(16);
+	}
+	std::vector<CaptureRecord> records;
+	CaptureReader::parse(sink.stream.data(), sink.stream.size(), records);
+	return records;
+}
+
+// protocol-aware capture codec against the raw stream and zlib on the same 4 KiB sectors
+static void benchCaptureCodec(BenchRunner& bench) {
+	bool selected = false;
+	for (const char* name : {"capture_codec/encode", "capture_codec/decode", "capture_codec/raw_parse",
+	                         "capture_codec/zlib_deflate_4k", "capture_codec/zlib_inflate_whole"}) {
+		selected |= bench.selected(name);
+	}
+	if (!selected) { return; }
+
+	std::vector<CaptureRecord> records = simulatedCapture();
+	BufferCaptureSink raw;
+	BufferCaptureSink coded;
+	CaptureCodec sinkCodec;
+	coded.setCodec(&sinkCodec);
+	for (const CaptureRecord& record : records) {
+		uint8_t serialized[BUS_CAPTURE_RECORD_MAX];
+		size_t len = record.serialize(serialized, sizeof(serialized));
+		raw.append(serialized, len);
+		coded.append(serialized, len);
+	}
+	size_t rawBytes = raw.stream.size();
+
+	CaptureCodec codec;
+	std::vector<uint8_t> encoded(CAPTURE_CODEC_RECORD_MAX);
+	bench.run("capture_codec/encode", rawBytes, [&] {
+		codec.reset();
+		for (const CaptureRecord& record : records) {
+			doNotOptimize(codec.encode(record, encoded.data(), encoded.size()));
+		}
+	});
+	bench.run("capture_codec/decode", rawBytes, [&] {
+		doNotOptimize(CaptureReader::each(coded.stream.data(), coded.stream.size(), [](const CaptureRecord& record) {
+			doNotOptimize(record.length);
+		}));
+	});
+	bench.run("capture_codec/raw_parse", rawBytes, [&] {
+		doNotOptimize(CaptureReader::each(raw.stream.data(), raw.stream.size(), [](const CaptureRecord& record) {
+			doNotOptimize(record.length);
+		}));
+	});
+	printf("capture_codec: %zu records, raw %zu B, codec %zu B (%.2fx)", records.size(), rawBytes, coded.stream.size(),
+	       static_cast<double>(rawBytes) / coded.stream.size());
+
+#ifdef ESTIA_HAVE_ZLIB
+	std::vector<uint8_t> deflated(compressBound(BUS_CAPTURE_SECTOR_SIZE));
+	size_t zlibBytes = 0;
+	for (size_t offset = 0; offset < rawBytes; offset += BUS_CAPTURE_SECTOR_SIZE) {
+		uLongf len = deflated.size();
+		compress2(deflated.data(), &len, raw.stream.data() + offset, std::min<size_t>(BUS_CAPTURE_SECTOR_SIZE, rawBytes - offset), Z_DEFAULT_COMPRESSION);
+		zlibBytes += len;
+	}
+	uLongf wholeLen = compressBound(rawBytes);
+	std::vector<uint8_t> whole(wholeLen);
+	compress2(whole.data(), &wholeLen, raw.stream.data(), rawBytes, Z_DEFAULT_COMPRESSION);
+	printf(", zlib 4 KiB sectors %zu B (%.2fx), zlib whole stream %lu B (%.2fx)\n", zlibBytes,
+	       static_cast<double>(rawBytes) / zlibBytes, wholeLen, static_cast<double>(rawBytes) / wholeLen);
+
+	bench.run("capture_codec/zlib_deflate_4k", rawBytes, [&] {
+		for (size_t offset = 0; offset < rawBytes; offset += BUS_CAPTURE_SECTOR_SIZE) {
+			uLongf len = deflated.size();
+			compress2(deflated.data(), &len, raw.stream.data() + offset, std::min<size_t>(BUS_CAPTURE_SECTOR_SIZE, rawBytes - offset), Z_DEFAULT_COMPRESSION);
+			doNotOptimize(len);
+		}
+	});
+	std::vector<uint8_t> inflated(rawBytes);
+	bench.run("capture_codec/zlib_inflate_whole", rawBytes, [&] {
+		uLongf len = inflated.size();
+		uncompress(inflated.data(), &len, whole.data(), wholeLen);
+		doNotOptimize(len);
+	});
+#else
+	printf("\n");
+#endif
+}
+
+// minimized worst-case inputs kept by estia-fuzz as a regression benchmark
+static void benchPathological(BenchRunner& bench) {
+	DIR* dir = opendir(ESTIA_PATHOLOGICAL_DIR);
+	if (!dir) { return; }
+	std::vector<std::string> names;
+	while (dirent* entry = readdir(dir)) {
+		if (entry->d_name[0] != '.') { names.push_back(entry->d_name); }
+	}
+	closedir(dir);
+	std::sort(names.begin(), names.end());
+
+	for (auto& name : names) {
+		FILE* file = fopen((std::string(ESTIA_PATHOLOGICAL_DIR "/") + name).c_str(), "rb");
+		if (!file) { continue; }
+		FrameBuffer input;
+		int byte;
+		while ((byte = fgetc(file)) != EOF) {
+			input.push_back(static_cast<uint8_t>(byte));
+		}
+		fclose(file);
+
+		SimClock clock;
+		BufferUart uart;
+		EstiaSerial estiaSerial(uart, clock);
+		std::string benchName = "pathological/" + name.substr(0, name.find('.'));
+		bench.run(
+		    benchName.c_str(), input.size(),
+		    [&] {
+			    sniff(estiaSerial, uart, clock);
+		    },
+		    [&] {
+			    uart.feed(input.data(), input.size());
+		    });
+	}
+}
+
+// precomputed TX frames must match what the runtime frame classes build
+template <typename Frame>
+static bool sameFrame(const TxFrame& tx, const Frame& frame) {
+	return tx.size() == frame.size() && memcmp(tx.data(), frame.data(), tx.size()) == 0;
+}
+
+static bool checkFrameTables() {
+	bool ok = true;
+	const uint8_t codes[] = {REQUEST_CODES, 0x33};    // plus one outside the table
+	for (uint8_t code : codes) {
+		ok &= sameFrame(FrameTables::request(code), DataReqFrame(code));
+	}
+	for (uint8_t onOff : {0, 1}) {
+		for (uint8_t mode : {SET_AUTO_MODE_CODE, SET_QUIET_MODE_CODE, SET_NIGHT_MODE_CODE}) {
+			ok &= sameFrame(FrameTables::mode(mode, onOff), SetModeFrame(mode, onOff));
+		}
+		for (uint8_t operation : {SWITCH_OPERATION_COOL_HEAT, SWITCH_OPERATION_HOT_WATER}) {
+			ok &= sameFrame(FrameTables::operationSwitch(operation, onOff), SwitchFrame(operation, onOff));
+		}
+		ok &= sameFrame(FrameTables::forceDefrost(onOff), ForcedDefrostFrame(onOff));
+	}
+	for (uint8_t mode : {OPERATION_MODE_COOLING, OPERATION_MODE_HEATING}) {
+		ok &= sameFrame(FrameTables::operationMode(mode), OperationMode(mode));
+	}
+	for (uint8_t zone : {TEMPERATURE_COOLING_CODE, TEMPERATURE_HEATING_CODE, TEMPERATURE_HOT_WATER_CODE}) {
+		for (uint8_t temperature = 0; temperature < 90; temperature += 7) {
+			ok &= sameFrame(FrameTables::temperature(zone, temperature, temperature + 1, temperature + 2),
+			                TemperatureFrame(zone, temperature, temperature + 1, temperature + 2));
+		}
+	}
+	return ok;
+}
+
+int main(int argc, char** argv) {
+	BenchRunner bench(argc, argv);
+
+	FrameBuffer maxFrame(FRAME_MAX_LEN, 0x5a);
+	for (size_t idx = 0; idx < maxFrame.size(); idx++) {
+		maxFrame.at(idx) = idx * 37;
+	}
+	if (crc16Legacy(maxFrame.data(), maxFrame.size()) != Crc16::computeTable(maxFrame.data(), maxFrame.size())
+	    || crc16Legacy(maxFrame.data(), maxFrame.size()) != Crc16::computeNibble(maxFrame.data(), maxFrame.size())
+	    || crc16Legacy(maxFrame.data(), maxFrame.size()) != Crc16::computeBitwise(maxFrame.data(), maxFrame.size())) {
+		fprintf(stderr, "crc16 kernels disagree with the reference\n");
+		return 1;
+	}
+	FrameCrc statusCrc;
+	for (auto byte : statusFrame()) {
+		statusCrc.update(byte);
+	}
+	if (!statusCrc.valid()) {
+		fprintf(stderr, "running frame crc rejects a valid frame\n");
+		return 1;
+	}
+	char statusHex[FRAME_HEX_SIZE];
+	EstiaFrame::toHex(statusFrame().data(), statusFrame().size(), statusHex, sizeof(statusHex));
+	if (EstiaFrame::stringify(statusFrame()) != statusHex) {
+		fprintf(stderr, "hex encoder differs from stringify\n");
+		return 1;
+	}
+	if (!checkFrameTables()) {
+		fprintf(stderr, "precomputed TX frames differ from the frame classes\n");
+		return 1;
+	}
+	bench.run("crc16/45B", maxFrame.size(), [&] {
+		doNotOptimize(EstiaFrame::crc16(maxFrame.data(), maxFrame.size()));
+	});
+	bench.run("crc16/legacy_45B", maxFrame.size(), [&] {
+		doNotOptimize(crc16Legacy(maxFrame.data(), maxFrame.size()));
+	});
+	bench.run("crc16/bitwise_45B", maxFrame.size(), [&] {
+		doNotOptimize(Crc16::computeBitwise(maxFrame.data(), maxFrame.size()));
+	});
+	bench.run("crc16/nibble_45B", maxFrame.size(), [&] {
+		doNotOptimize(Crc16::computeNibble(maxFrame.data(), maxFrame.size()));
+	});
+	bench.run("crc16/table_45B", maxFrame.size(), [&] {
+		doNotOptimize(Crc16::computeTable(maxFrame.data(), maxFrame.size()));
+	});
+	bench.run("crc16/incremental_45B", maxFrame.size(), [&] {
+		FrameCrc frameCrc;
+		for (auto byte : maxFrame) {
+			frameCrc.update(byte);
+		}
+		doNotOptimize(frameCrc.valid());
+	});
+
+	SimClock clock;
+	BufferUart uart;
+	EstiaSerial estiaSerial(uart, clock);
+	FrameBuffer stream = busStream();
+	bench.run(
+	    "serial/read", stream.size(),
+	    [&] {
+		    while (EstiaSerialBench::read(estiaSerial)) {}
+	    },
+	    [&] {
+		    EstiaSerialBench::snifferBuffer(estiaSerial).clear();
+		    uart.feed(stream.data(), stream.size());
+	    });
+	bench.run(
+	    "serial/syncSnifferBuffer", stream.size(),
+	    [&] {
+		    while (!EstiaSerialBench::snifferBuffer(estiaSerial).empty()) {
+			    EstiaSerialBench::syncSnifferBuffer(estiaSerial);
+		    }
+	    },
+	    [&] {
+		    EstiaSerialBench::sniffedFrames(estiaSerial).clear();
+		    ReadBuffer& snifferBuffer = EstiaSerialBench::snifferBuffer(estiaSerial);
+		    snifferBuffer.clear();
+		    for (uint8_t byte : stream) {
+			    snifferBuffer.push_back(byte);
+		    }
+	    });
+	FrameBuffer sweepResponse = dataResFrame();
+	FrameView responseView(sweepResponse);
+	const SensorList& sweep = SensorRegistry::defaults();
+	bench.run(
+	    "serial/response", sweepResponse.size() * sweep.size(),
+	    [&] { EstiaSerialBench::answerSweep(estiaSerial, responseView); },
+	    [&] { estiaSerial.requestSensorsData(sweep, true); });
+
+	FrameFixer frameFixer;
+	FrameBuffer fixInput;
+	FrameBuffer fixBuffer;
+	auto fixFrame = [&] {
+		doNotOptimize(frameFixer.fixFrame(fixBuffer));
+	};
+	auto fixReset = [&] {
+		fixBuffer = fixInput;
+	};
+	fixInput = statusFrame();
+	bench.run("fixer/clean", fixInput.size(), fixFrame, fixReset);
+	fixInput = statusFrame();
+	fixInput.at(FRAME_TYPE_OFFSET) ^= 0x04;
+	bench.run("fixer/corrupt_type", fixInput.size(), fixFrame, fixReset);
+	fixInput = statusFrame();
+	fixInput.at(FRAME_DATA_OFFSET + 4) ^= 0x10;
+	bench.run("fixer/corrupt_payload", fixInput.size(), fixFrame, fixReset);
+	fixInput = statusFrame();
+	fixInput.at(FRAME_TYPE_OFFSET) = FRAME_TYPE_UPDATE;
+	EstiaFrame::writeUint16(fixInput, FRAME_DST_OFFSET, 0x5a5a);
+	bench.run("fixer/corrupt_header", fixInput.size(), fixFrame, fixReset);
+	fixInput = statusFrame();
+	fixInput.erase(fixInput.begin());
+	bench.run("fixer/truncated_head", fixInput.size(), fixFrame, fixReset);
+	fixInput = statusFrame();
+	fixInput.resize(fixInput.size() - 5);
+	bench.run("fixer/truncated_tail", fixInput.size(), fixFrame, fixReset);
+
+	FrameBuffer status = statusFrame();
+	bench.run("status/construct", status.size(), [&] {
+		StatusFrame statusFrame(status, status.size());
+		doNotOptimize(statusFrame.error);
+	});
+	StatusFrame decodeFrame(status, status.size());
+	bench.run("status/decode", status.size(), [&] {
+		StatusData data = decodeFrame.decode();
+		doNotOptimize(data);
+	});
+	bench.run("status/view", status.size(), [&] {
+		StatusData data = StatusFrame::decode(FrameView(status));
+		doNotOptimize(data);
+	});
+
+	// sniffer dispatch after the fixer: is*Frame() chain and checked decode
+	// against one lookup reusing the fixer CRC verdict
+	FrameFixer dispatchFixer;
+	bench.run("dispatch/checked", status.size(), [&] {
+		dispatchFixer.fixFrame(status);
+		FrameView view(status);
+		StatusData data = {};
+		if (EstiaFrame::isStatusFrame(view) || EstiaFrame::isStatusUpdateFrame(view)) { data = StatusFrame::decode(view); }
+		doNotOptimize(data);
+	});
+	FrameClassifier classifier;
+	bench.run("dispatch/classified", status.size(), [&] {
+		bool crcValid = dispatchFixer.fixFrame(status);
+		FrameView view(status);
+		StatusData data = {};
+		FrameClass frameClass = classifier.classify(view, crcValid);
+		if (frameClass.kind == frame_status && frameClass.valid()) { data = StatusFrame::decodeUnchecked(view); }
+		doNotOptimize(data);
+	});
+
+	// deferred log: what loop() pays per status frame against the formatting
+	// a log consumer does later
+	BinaryLog binaryLog;
+	LogRecord logRecord;
+	StatusData statusData = StatusFrame::decode(FrameView(status));
+	bench.run("log/status_record", sizeof(PackedStatus), [&] {
+		binaryLog.logStatus(1000, statusData);
+		binaryLog.pop(logRecord);
+		doNotOptimize(logRecord.length);
+	});
+	// nobody listening: the ring stays full and every record replaces the oldest
+	BinaryLog unreadLog;
+	bench.run("log/status_unread", sizeof(PackedStatus), [&] {
+		unreadLog.logStatus(1000, statusData);
+		doNotOptimize(unreadLog.size());
+	});
+	bench.run("log/status_format", sizeof(PackedStatus), [&] {
+		char line[BINARY_LOG_LINE_SIZE];
+		doNotOptimize(logRecord.format(line, sizeof(line)));
+		doNotOptimize(line[0]);
+	});
+
+	BusCapture busCapture;
+	CaptureRecord captureRecord;
+	bench.run("capture/record", status.size(), [&] {
+		busCapture.record(1000, 0, status.data(), status.size());
+		busCapture.amendLast(capture_crc_valid);
+		busCapture.pop(captureRecord);
+		doNotOptimize(captureRecord.length);
+	});
+
+	FrameBuffer response = dataResFrame();
+	bench.run("data_res/construct", response.size(), [&] {
+		DataResFrame resFrame(response);
+		doNotOptimize(resFrame.value);
+	});
+	bench.run("data_res/view", response.size(), [&] {
+		DataResponse decoded = DataResFrame::decode(FrameView(response));
+		doNotOptimize(decoded.value);
+	});
+
+	bench.run("tx/request_runtime", FRAME_REQ_DATA_LEN, [&] {
+		DataReqFrame request(CODE_TWO);
+		doNotOptimize(request.data());
+	});
+	bench.run("tx/request_table", FRAME_REQ_DATA_LEN, [&] {
+		TxFrame request = FrameTables::request(CODE_TWO);
+		doNotOptimize(request.data());
+	});
+	bench.run("tx/temperature_runtime", FRAME_TEMPERATURE_LEN, [&] {
+		TemperatureFrame temperature(TEMPERATURE_HEATING_CODE, 35, 30, 50);
+		doNotOptimize(temperature.data());
+	});
+	bench.run("tx/temperature_builder", FRAME_TEMPERATURE_LEN, [&] {
+		TxFrame temperature = FrameTables::temperature(TEMPERATURE_HEATING_CODE, 35, 30, 50);
+		doNotOptimize(temperature.data());
+	});
+
+	bench.run("stringify/status", status.size(), [&] {
+		std::string hex = EstiaFrame::stringify(status);
+		doNotOptimize(hex.data());
+	});
+	bench.run("stringify/to_hex", status.size(), [&] {
+		char hex[FRAME_HEX_SIZE];
+		doNotOptimize(EstiaFrame::toHex(status.data(), status.size(), hex, sizeof(hex)));
+		doNotOptimize(hex[0]);
+	});
+
+	FrameBuffer busBytes = busStream();
+	bench.run(
+	    "sniffer/bus_stream", busBytes.size(),
+	    [&] {
+		    sniff(estiaSerial, uart, clock);
+	    },
+	    [&] {
+		    uart.feed(busBytes.data(), busBytes.size());
+	    });
+	benchPathological(bench);
+	benchCaptureCodec(bench);
+
+	return bench.finish();
+}
@@ -0,0 +1,447 @@
+/*
+estia-fuzz.cpp - worst-case cost fuzz target for the sniffer pipeline
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "estia-serial.hpp"
+#include "host-hal.hpp"
+#include "sim-clock.hpp"
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <malloc.h>
+#include <new>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/**
+* Fuzz target: raw bus bytes -> `EstiaSerial::sniffer()` (read, split,
+* FrameFixer, decoders) until the pipeline is idle again.
+*
+* Every run is costed by executed basic blocks (deterministic, from the
+* `-fsanitize-coverage=trace-pc` hook below; wall time under libFuzzer) and by
+* peak heap growth. The inputs with the highest cost per byte and the highest
+* heap growth are reported, and can be minimized and written out as a
+* regression corpus for `estia-bench`.
+*
+* Built-in driver usage:
+*   estia-fuzz [-runs N] [-seed N] [-max_len N] [-corpus DIR] [-worst DIR] [-minimize 1]
+*   estia-fuzz -replay DIR
+*/
+
+#define FUZZ_MAP_SIZE (1 << 16)
+#define FUZZ_WORST_KEEP 8
+#define FUZZ_MIN_COST_LEN 8    // shorter inputs make cost per byte meaningless
+#define FUZZ_MAX_SNIFFER_CALLS 100000
+
+using Input = std::vector<uint8_t>;
+
+static uint8_t coverageMap[FUZZ_MAP_SIZE];
+static uintptr_t coveragePrev = 0;
+static uint64_t coverageBlocks = 0;
+static bool coverageEnabled = false;
+
+static size_t heapCurrent = 0;
+static size_t heapPeak = 0;
+
+#ifndef ESTIA_LIBFUZZER
+// AFL-style edge coverage from GCC/clang -fsanitize-coverage=trace-pc
+extern "C" void __sanitizer_cov_trace_pc() {
+	if (!coverageEnabled) { return; }
+	uintptr_t pc = reinterpret_cast<uintptr_t>(__builtin_return_address(0));
+	uintptr_t loc = (pc ^ (pc >> 12)) & (FUZZ_MAP_SIZE - 1);
+	coverageMap[loc ^ coveragePrev]++;
+	coveragePrev = loc >> 1;
+	coverageBlocks++;
+}
+#endif
+
+void* operator new(size_t size) {
+	void* ptr = malloc(size ? size : 1);
+	if (!ptr) { throw std::bad_alloc(); }
+	heapCurrent += malloc_usable_size(ptr);
+	if (heapCurrent > heapPeak) { heapPeak = heapCurrent; }
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+	if (!ptr) { return; }
+	heapCurrent -= malloc_usable_size(ptr);
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	operator delete(ptr);
+}
+
+struct RunCost {
+	uint64_t blocks;
+	uint64_t ns;
+	size_t heapGrowth;
+	uint32_t frames;
+	bool stalled;
+
+	double perByte(size_t len) const { return static_cast<double>(blocks ? blocks : ns) / (len ? len : 1); }
+};
+
+static RunCost runSniffer(const uint8_t* data, size_t size) {
+	RunCost cost = {};
+	SimClock clock;
+	BufferUart uart;
+	EstiaSerial estiaSerial(uart, clock);
+	uart.feed(data, size);
+
+	size_t heapStart = heapCurrent;
+	heapPeak = heapCurrent;
+	coveragePrev = 0;
+	coverageBlocks = 0;
+	coverageEnabled = true;
+	auto start = std::chrono::steady_clock::now();
+	uint32_t calls = 0;
+	int lastAvailable = -1;
+	uint32_t quietSince = 0;
+	while (true) {
+		EstiaSerial::SnifferState state = estiaSerial.sniffer();
+		if (state == EstiaSerial::sniff_idle) { break; }
+		if (state == EstiaSerial::sniff_frame_pending) {
+			estiaSerial.getSniffedFrame();
+			cost.frames++;
+		} else {
+			// jump straight to the frame gap instead of polling towards it,
+			// so waiting doesn't count as pipeline work
+			clock.delay(uart.available() ? 1 : ESTIA_SERIAL_FRAME_GAP);
+		}
+		// anything left unread once the sniffer goes quiet is a stall
+		int available = uart.available();
+		if (available != lastAvailable || state == EstiaSerial::sniff_frame_pending) {
+			lastAvailable = available;
+			quietSince = clock.millis();
+		} else if (clock.millis() - quietSince > 2 * ESTIA_SERIAL_FRAME_GAP) {
+			cost.stalled = available > 0;
+			break;
+		}
+		if (++calls > FUZZ_MAX_SNIFFER_CALLS) {
+			cost.stalled = true;
+			break;
+		}
+	}
+	cost.ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	coverageEnabled = false;
+	cost.blocks = coverageBlocks;
+	cost.heapGrowth = heapPeak - heapStart;
+	return cost;
+}
+
+struct Worst {
+	Input input;
+	RunCost cost;
+};
+
+static std::vector<Worst> worstCpu;
+static std::vector<Worst> worstHeap;
+
+template <typename Key>
+static void keepWorst(std::vector<Worst>& worst, const Input& input, const RunCost& cost, Key key) {
+	if (worst.size() >= FUZZ_WORST_KEEP && key(worst.back()) >= key({input, cost})) { return; }
+	worst.push_back({input, cost});
+	std::sort(worst.begin(), worst.end(), [&](const Worst& a, const Worst& b) { return key(a) > key(b); });
+	if (worst.size() > FUZZ_WORST_KEEP) { worst.pop_back(); }
+}
+
+static double cpuKey(const Worst& worst) {
+	return worst.input.size() < FUZZ_MIN_COST_LEN ? 0 : worst.cost.perByte(worst.input.size());
+}
+
+static double heapKey(const Worst& worst) {
+	return static_cast<double>(worst.cost.heapGrowth);
+}
+
+static void trackCost(const Input& input, const RunCost& cost) {
+	keepWorst(worstCpu, input, cost, cpuKey);
+	keepWorst(worstHeap, input, cost, heapKey);
+	if (cost.stalled) {
+		fprintf(stderr, "sniffer stalled on %zu byte input\n", input.size());
+	}
+}
+
+static void printWorst() {
+	printf("highest cost per byte (%s):\n", worstCpu.empty() || worstCpu.front().cost.blocks ? "blocks" : "ns");
+	for (auto& worst : worstCpu) {
+		printf("  %8.1f /byte  len %4zu  frames %3u  heap %6zu B\n", worst.cost.perByte(worst.input.size()), worst.input.size(),
+		       worst.cost.frames, worst.cost.heapGrowth);
+	}
+	printf("highest heap growth:\n");
+	for (auto& worst : worstHeap) {
+		printf("  %8zu B  len %4zu  frames %3u  %8.1f /byte\n", worst.cost.heapGrowth, worst.input.size(), worst.cost.frames,
+		       worst.cost.perByte(worst.input.size()));
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	Input input(data, data + size);
+	trackCost(input, runSniffer(data, size));
+	return 0;
+}
+
+#ifdef ESTIA_LIBFUZZER
+extern "C" int LLVMFuzzerInitialize(int*, char***) {
+	atexit(printWorst);
+	return 0;
+}
+#else
+
+static const Input dictionary[] = {
+    {0xa0, 0x00},
+    {0xa0, 0x00, 0x10, 0x07, 0x00, 0x08, 0x00, 0x00, 0xfe, 0x00, 0x8a, 0x75, 0x05},
+    {0xa0, 0x00, 0x58, 0x19, 0x00, 0x08, 0x00, 0x00, 0xfe, 0x03, 0xc6, 0xc3, 0x00, 0x12, 0x84, 0x66, 0x66, 0x84, 0x66, 0x66,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x54, 0x6b},
+    {0xa0, 0x00, 0x1a, 0x0d, 0x00, 0x08, 0x00, 0x00, 0x40, 0x00, 0xef, 0x00, 0x80, 0x00, 0x2c, 0x00, 0x23, 0x88, 0x6c},
+    {0xa0, 0x00, 0x1c, 0x0f, 0x00, 0x08, 0x00, 0x00, 0xfe, 0x03, 0xc6, 0xc3, 0x00, 0x12, 0x84, 0x66, 0x66, 0x00, 0x00, 0xfc, 0xa1},
+    {0xa0, 0x00, 0x55, 0x09, 0x00, 0x00, 0x40, 0x08, 0x00, 0x03, 0xc6, 0x00, 0x00, 0xae, 0x4c},
+    {0xa0, 0x00, 0x18, 0x09, 0x00, 0x08, 0x00, 0x08, 0x00, 0x00, 0xa1, 0x00, 0x41, 0xc1, 0x95},
+};
+
+static const uint8_t interestingBytes[] = {0xa0, 0x00, 0x10, 0x11, 0x17, 0x18, 0x1a, 0x1c, 0x55, 0x58, 0x07, 0x09,
+                                           0x0b, 0x0d, 0x0f, 0x19, 0x2d, 0xff, 0x08, 0x40, 0xfe};
+
+class FuzzDriver {
+  private:
+	std::mt19937 rng;
+	size_t maxLen;
+	std::vector<Input> corpus;
+	uint8_t virginMap[FUZZ_MAP_SIZE];
+	std::string corpusDir;
+
+	size_t pick(size_t range) { return range ? rng() % range : 0; }
+
+	bool newCoverage() {
+		bool found = false;
+		for (size_t idx = 0; idx < FUZZ_MAP_SIZE; idx++) {
+			if (!coverageMap[idx]) { continue; }
+			// bucket hit counts like AFL so loop-count changes count as new behaviour
+			uint8_t hits = coverageMap[idx];
+			uint8_t bucket = hits >= 128 ? 0x80 : hits >= 32 ? 0x40 : hits >= 16 ? 0x20 : hits >= 8 ? 0x10 : hits >= 4 ? 0x08 : hits;
+			if (virginMap[idx] & bucket) { continue; }
+			virginMap[idx] |= bucket;
+			found = true;
+		}
+		memset(coverageMap, 0, sizeof(coverageMap));
+		return found;
+	}
+
+	void mutate(Input& input) {
+		uint32_t rounds = 1 + pick(4);
+		for (uint32_t round = 0; round < rounds; round++) {
+			switch (pick(9)) {
+			case 0:
+				if (!input.empty()) { input.at(pick(input.size())) ^= 1 << pick(8); }
+				break;
+			case 1:
+				if (!input.empty()) { input.at(pick(input.size())) = interestingBytes[pick(sizeof(interestingBytes))]; }
+				break;
+			case 2:
+				input.insert(input.begin() + pick(input.size() + 1), {0xa0, 0x00});
+				break;
+			case 3:
+				if (input.size() > 1) {
+					size_t from = pick(input.size());
+					size_t len = 1 + pick(std::min<size_t>(input.size() - from, 16));
+					input.erase(input.begin() + from, input.begin() + from + len);
+				}
+				break;
+			case 4:
+				if (!input.empty()) {
+					size_t from = pick(input.size());
+					size_t len = 1 + pick(std::min<size_t>(input.size() - from, 32));
+					Input chunk(input.begin() + from, input.begin() + from + len);
+					input.insert(input.begin() + pick(input.size() + 1), chunk.begin(), chunk.end());
+				}
+				break;
+			case 5: {
+				const Input& other = corpus.at(pick(corpus.size()));
+				if (!other.empty()) {
+					size_t from = pick(other.size());
+					input.insert(input.begin() + pick(input.size() + 1), other.begin() + from, other.end());
+				}
+				break;
+			}
+			case 6: {
+				const Input& frame = dictionary[pick(sizeof(dictionary) / sizeof(dictionary[0]))];
+				input.insert(input.begin() + pick(input.size() + 1), frame.begin(), frame.end());
+				break;
+			}
+			case 7:
+				if (!input.empty()) { input.resize(pick(input.size())); }
+				break;
+			case 8:
+				input.insert(input.begin() + pick(input.size() + 1), 1 + pick(8), static_cast<uint8_t>(rng()));
+				break;
+			}
+		}
+		if (input.size() > maxLen) { input.resize(maxLen); }
+	}
+
+	void save(const std::string& dir, const Input& input) {
+		if (dir.empty()) { return; }
+		uint64_t hash = 14695981039346656037ULL;
+		for (auto byte : input) {
+			hash = (hash ^ byte) * 1099511628211ULL;
+		}
+		char path[512];
+		snprintf(path, sizeof(path), "%s/%016llx.bin", dir.c_str(), static_cast<unsigned long long>(hash));
+		FILE* file = fopen(path, "wb");
+		if (!file) { return; }
+		fwrite(input.data(), 1, input.size(), file);
+		fclose(file);
+	}
+
+  public:
+	FuzzDriver(uint32_t seed, size_t maxLen, const std::string& corpusDir)
+	    : rng(seed)
+	    , maxLen(maxLen)
+	    , corpus()
+	    , virginMap()
+	    , corpusDir(corpusDir) {
+		for (auto& input : loadDir(corpusDir)) {
+			add(input);
+		}
+		for (auto& frame : dictionary) {
+			add(frame);
+		}
+	}
+
+	static std::vector<Input> loadDir(const std::string& dir) {
+		std::vector<Input> inputs;
+		DIR* handle = dir.empty() ? nullptr : opendir(dir.c_str());
+		if (!handle) { return inputs; }
+		std::vector<std::string> names;
+		while (dirent* entry = readdir(handle)) {
+			if (entry->d_name[0] != '.') { names.push_back(entry->d_name); }
+		}
+		closedir(handle);
+		std::sort(names.begin(), names.end());
+		for (auto& name : names) {
+			FILE* file = fopen((dir + "/" + name).c_str(), "rb");
+			if (!file) { continue; }
+			Input input;
+			int byte;
+			while ((byte = fgetc(file)) != EOF) {
+				input.push_back(static_cast<uint8_t>(byte));
+			}
+			fclose(file);
+			inputs.push_back(input);
+		}
+		return inputs;
+	}
+
+	bool add(const Input& input) {
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+		if (!newCoverage()) { return false; }
+		corpus.push_back(input);
+		return true;
+	}
+
+	void fuzz(uint64_t runs) {
+		for (uint64_t run = 0; run < runs; run++) {
+			Input input = corpus.at(pick(corpus.size()));
+			mutate(input);
+			if (add(input)) { save(corpusDir, input); }
+		}
+		printf("runs %llu, corpus %zu\n", static_cast<unsigned long long>(runs), corpus.size());
+	}
+
+	// greedy chunk removal that keeps the cost metric at least as high
+	static Input minimize(const Input& input, bool heap) {
+		Input best = input;
+		RunCost bestCost = runSniffer(best.data(), best.size());
+		for (size_t chunk = best.size() / 2; chunk > 0; chunk /= 2) {
+			for (size_t from = 0; from + chunk <= best.size();) {
+				Input candidate = best;
+				candidate.erase(candidate.begin() + from, candidate.begin() + from + chunk);
+				RunCost cost = runSniffer(candidate.data(), candidate.size());
+				bool keep = heap ? cost.heapGrowth >= bestCost.heapGrowth
+				                 : candidate.size() >= FUZZ_MIN_COST_LEN && cost.perByte(candidate.size()) >= bestCost.perByte(best.size());
+				if (keep) {
+					best = candidate;
+					bestCost = cost;
+				} else {
+					from += chunk;
+				}
+			}
+		}
+		return best;
+	}
+
+	void saveWorst(const std::string& dir, bool minimizeInputs) {
+		for (auto& worst : worstCpu) {
+			save(dir, minimizeInputs ? minimize(worst.input, false) : worst.input);
+		}
+		for (auto& worst : worstHeap) {
+			save(dir, minimizeInputs ? minimize(worst.input, true) : worst.input);
+		}
+	}
+};
+
+int main(int argc, char** argv) {
+	uint64_t runs = 100000;
+	uint32_t seed = 1;
+	size_t maxLen = 512;
+	bool minimizeInputs = false;
+	std::string corpusDir;
+	std::string worstDir;
+	std::string replayDir;
+	for (int idx = 1; idx + 1 < argc; idx += 2) {
+		const char* arg = argv[idx];
+		const char* value = argv[idx + 1];
+		if (strcmp(arg, "-runs") == 0) {
+			runs = strtoull(value, nullptr, 0);
+		} else if (strcmp(arg, "-seed") == 0) {
+			seed = strtoul(value, nullptr, 0);
+		} else if (strcmp(arg, "-max_len") == 0) {
+			maxLen = strtoul(value, nullptr, 0);
+		} else if (strcmp(arg, "-corpus") == 0) {
+			corpusDir = value;
+		} else if (strcmp(arg, "-worst") == 0) {
+			worstDir = value;
+		} else if (strcmp(arg, "-minimize") == 0) {
+			minimizeInputs = atoi(value) != 0;
+		} else if (strcmp(arg, "-replay") == 0) {
+			replayDir = value;
+		} else {
+			fprintf(stderr, "unknown option %s\n", arg);
+			return 1;
+		}
+	}
+
+	if (!replayDir.empty()) {
+		for (auto& input : FuzzDriver::loadDir(replayDir)) {
+			trackCost(input, runSniffer(input.data(), input.size()));
+		}
+		printWorst();
+		return 0;
+	}
+
+	FuzzDriver driver(seed, maxLen, corpusDir);
+	driver.fuzz(runs);
+	printWorst();
+	if (!worstDir.empty()) { driver.saveWorst(worstDir, minimizeInputs); }
+	return 0;
+}
+#endif
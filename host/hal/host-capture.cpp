@@ -0,0 +1,72 @@
+/*
+host-capture.cpp - bus capture files on the host
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "host-capture.hpp"
+#include <algorithm>
+
+FileCaptureSink::FileCaptureSink(FILE* file)
+    : file(file) {
+}
+
+bool FileCaptureSink::write(size_t /* offset */, const uint8_t* data, size_t len) {
+	return fwrite(data, 1, len, file) == len;
+}
+
+bool BufferCaptureSink::write(size_t /* offset */, const uint8_t* data, size_t len) {
+	stream.insert(stream.end(), data, data + len);
+	return true;
+}
+
+static bool sectorErased(const uint8_t* sector) {
+	return sector[5] == BUS_CAPTURE_PADDING;
+}
+
+size_t CaptureReader::oldestSector(const uint8_t* data, size_t len) {
+	size_t sectors = len / BUS_CAPTURE_SECTOR_SIZE;
+	if (sectors < 2 || len % BUS_CAPTURE_SECTOR_SIZE != 0) { return 0; }
+
+	for (size_t idx = 0; idx < sectors; idx++) {
+		size_t next = (idx + 1) % sectors;
+		if (sectorErased(data + idx * BUS_CAPTURE_SECTOR_SIZE) && !sectorErased(data + next * BUS_CAPTURE_SECTOR_SIZE)) {
+			return next * BUS_CAPTURE_SECTOR_SIZE;
+		}
+	}
+	return 0;
+}
+
+size_t CaptureReader::parse(const uint8_t* data, size_t len, std::vector<CaptureRecord>& records) {
+	return each(data, len, [&](const CaptureRecord& record) { records.push_back(record); });
+}
+
+bool CaptureReader::load(const char* path, std::vector<CaptureRecord>& records) {
+	FILE* file = fopen(path, "rb");
+	if (!file) { return false; }
+
+	std::vector<uint8_t> data;
+	uint8_t chunk[4096];
+	size_t len;
+	while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+		data.insert(data.end(), chunk, chunk + len);
+	}
+	fclose(file);
+
+	size_t oldest = oldestSector(data.data(), data.size());
+	std::rotate(data.begin(), data.begin() + oldest, data.end());
+	parse(data.data(), data.size(), records);
+	return true;
+}
@@ -0,0 +1,101 @@
+/*
+host-capture.hpp - bus capture files on the host
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "bus-capture.hpp"
+#include "capture-codec.hpp"
+#include <stdio.h>
+#include <vector>
+
+/**
+* CaptureSink appending to a file, same sector layout as the flash sink so
+* one reader handles both.
+*/
+class FileCaptureSink : public CaptureSink {
+  private:
+	FILE* file;
+
+  protected:
+	bool write(size_t offset, const uint8_t* data, size_t len) override;
+
+  public:
+	explicit FileCaptureSink(FILE* file);
+};
+
+// CaptureSink collecting the stream in memory
+class BufferCaptureSink : public CaptureSink {
+  protected:
+	bool write(size_t offset, const uint8_t* data, size_t len) override;
+
+  public:
+	std::vector<uint8_t> stream;
+};
+
+/**
+* Reading captures: a file written by `FileCaptureSink` or a raw dump of the
+* flash partition (`esptool.py read_flash`). A flash dump wraps around, its
+* oldest record is in the first written sector after an erased one. Each
+* sector holds raw or `CaptureCodec` encoded records, told apart by the
+* codec's sector header.
+*/
+class CaptureReader {
+  public:
+	static size_t oldestSector(const uint8_t* data, size_t len);    // byte offset, 0 for a file capture
+	static size_t parse(const uint8_t* data, size_t len, std::vector<CaptureRecord>& records);
+	template <typename Visit>
+	static size_t each(const uint8_t* data, size_t len, Visit visit);    // visit(const CaptureRecord&) in stream order
+	template <typename Visit>
+	static size_t eachInSector(const uint8_t* data, size_t len, size_t offset, CaptureCodec& codec, Visit visit);
+	static bool load(const char* path, std::vector<CaptureRecord>& records);
+};
+
+// `data` starts on a sector boundary, returns the number of records
+template <typename Visit>
+size_t CaptureReader::each(const uint8_t* data, size_t len, Visit visit) {
+	CaptureCodec codec;
+	size_t records = 0;
+	for (size_t sector = 0; sector < len; sector += BUS_CAPTURE_SECTOR_SIZE) {
+		size_t end = sector + BUS_CAPTURE_SECTOR_SIZE < len ? sector + BUS_CAPTURE_SECTOR_SIZE : len;
+		records += eachInSector(data + sector, end - sector, sector, codec, visit);
+	}
+	return records;
+}
+
+template <typename Visit>
+size_t CaptureReader::eachInSector(const uint8_t* data, size_t len, size_t offset, CaptureCodec& codec, Visit visit) {
+	CaptureRecord record;
+	size_t records = 0;
+	size_t pos = 0;
+	if (CaptureCodec::isSectorHeader(data, len)) {
+		codec.reset();
+		pos = CAPTURE_CODEC_SECTOR_HEADER_SIZE;
+		while (size_t used = codec.decode(data + pos, len - pos, record)) {
+			visit(static_cast<const CaptureRecord&>(record));
+			records++;
+			pos += used;
+		}
+		return records;
+	}
+	while (size_t used = CaptureRecord::deserialize(data + pos, len - pos, offset + pos, record)) {
+		visit(static_cast<const CaptureRecord&>(record));
+		records++;
+		pos += used;
+	}
+	return records;
+}
@@ -0,0 +1,70 @@
+/*
+host-hal.cpp - Estia R32 heat pump host (Linux) HAL
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "host-hal.hpp"
+#include <thread>
+
+HostClock::HostClock()
+    : start(std::chrono::steady_clock::now()) {
+}
+
+uint32_t HostClock::millis() {
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+uint32_t HostClock::micros() {
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+void HostClock::delay(uint32_t ms) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+BufferUart::BufferUart()
+    : rx()
+    , tx() {
+}
+
+void BufferUart::feed(const uint8_t* data, size_t len) {
+	rx.insert(rx.end(), data, data + len);
+}
+
+void BufferUart::feed(uint8_t byte) {
+	rx.push_back(byte);
+}
+
+int BufferUart::available() {
+	return static_cast<int>(rx.size());
+}
+
+uint8_t BufferUart::read() {
+	if (rx.empty()) { return 0x00; }
+
+	uint8_t byte = rx.front();
+	rx.pop_front();
+	return byte;
+}
+
+void BufferUart::write(const uint8_t* data, size_t len) {
+	tx.insert(tx.end(), data, data + len);
+}
+
+void BufferUart::flush() {
+}
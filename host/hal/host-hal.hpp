@@ -0,0 +1,60 @@
+/*
+host-hal.hpp - Estia R32 heat pump host (Linux) HAL
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "estia-hal.hpp"
+#include <chrono>
+#include <deque>
+#include <vector>
+
+/**
+* Wall clock backed by `std::chrono::steady_clock`.
+*/
+class HostClock : public EstiaClock {
+  private:
+	std::chrono::steady_clock::time_point start;
+
+  public:
+	HostClock();
+
+	uint32_t millis() override;
+	uint32_t micros() override;
+	void delay(uint32_t ms) override;
+};
+
+/**
+* In-memory UART: bytes fed with `feed()` are returned by `read()`,
+* everything written is collected in `tx`.
+*/
+class BufferUart : public EstiaUart {
+  private:
+	std::deque<uint8_t> rx;
+
+  public:
+	BufferUart();
+
+	std::vector<uint8_t> tx;
+
+	void feed(const uint8_t* data, size_t len);
+	void feed(uint8_t byte);
+	int available() override;
+	uint8_t read() override;
+	void write(const uint8_t* data, size_t len) override;
+	void flush() override;
+};
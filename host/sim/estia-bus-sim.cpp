@@ -0,0 +1,308 @@
+/*
+estia-bus-sim.cpp - simulated Estia R32 master/remote bus
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "estia-bus-sim.hpp"
+#include "commands-frames.hpp"
+#include "data-frames.hpp"
+#include "status-frames.hpp"
+#include <algorithm>
+
+#define MS_TO_US(ms) (static_cast<uint64_t>(ms) * 1000)
+
+EstiaBusSim::EstiaBusSim(SimClock& clock, const SimBusConfig& config)
+    : clock(clock)
+    , config(config)
+    , rng(config.seed)
+    , rx()
+    , wireBusyUntilUs(0)
+    , masterBusyUntilUs(0)
+    , nodeTxEndUs(0)
+    , nextHeartbeatUs(clock.uptimeUs() + MS_TO_US(config.heartbeatPeriodMs))
+    , nextStatusUs(clock.uptimeUs() + MS_TO_US(config.statusPeriodMs / 2))
+    , nextShortStatusUs(clock.uptimeUs() + MS_TO_US(config.shortStatusPeriodMs))
+    , nextRemoteStatusUs(clock.uptimeUs() + MS_TO_US(config.remoteStatusPeriodMs / 3))
+    , nextUpdateUs(clock.uptimeUs() + MS_TO_US(config.updatePeriodMs))
+    , replies()
+    , values()
+    , plant()
+    , stats() {
+	plant.operationMode = OPERATION_MODE_HEATING;
+	plant.zoneOn = true;
+	plant.pump1 = config.pump1;
+	plant.hotWaterTarget = 50;
+	plant.zone1Target = 35;
+	plant.zone2Target = 35;
+}
+
+void EstiaBusSim::setValue(uint8_t code, int16_t value) {
+	values[code] = value;
+}
+
+bool EstiaBusSim::chance(double rate) {
+	if (rate <= 0.0) { return false; }
+	return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < rate;
+}
+
+FrameBuffer EstiaBusSim::makeFrame(uint8_t type, uint16_t src, uint16_t dst, uint16_t dataType, const FrameBuffer& payload) {
+	FrameBuffer frame(FRAME_HEAD_LEN + FRAME_DATA_HEADER_LEN + payload.size() + FRAME_CRC_LEN, 0x00);
+	EstiaFrame::writeUint16(frame, 0, FRAME_BEGIN);
+	frame.at(FRAME_TYPE_OFFSET) = type;
+	frame.at(FRAME_DATA_LEN_OFFSET) = frame.size() - FRAME_HEAD_AND_CRC_LEN;
+	EstiaFrame::writeUint16(frame, FRAME_SRC_OFFSET, src);
+	EstiaFrame::writeUint16(frame, FRAME_DST_OFFSET, dst);
+	EstiaFrame::writeUint16(frame, FRAME_DATA_TYPE_OFFSET, dataType);
+	std::copy(payload.begin(), payload.end(), frame.begin() + FRAME_DATA_OFFSET);
+	EstiaFrame::writeUint16(frame, frame.size() - 2, EstiaFrame::crc16(frame.data(), frame.size() - 2));
+	return frame;
+}
+
+FrameBuffer EstiaBusSim::statusFrame(bool longFrame) {
+	FrameBuffer payload((longFrame ? FRAME_STATUS_LEN : FRAME_UPDATE_LEN) - FRAME_MIN_LEN, 0x00);
+	payload.at(0) = (plant.operationMode << 5) | (plant.zoneOn ? 0x01 : 0x00) | (plant.hotWater ? 0x02 : 0x00);
+	payload.at(1) = (plant.autoMode ? 0x04 : 0x00) | (plant.quietMode ? 0x10 : 0x00) | (plant.nightMode ? 0x20 : 0x00);
+	payload.at(2) = (plant.zoneOn ? 0x02 : 0x00) | (plant.pump1 ? 0x10 : 0x00);
+	payload.at(3) = (plant.hotWaterTarget + 0x10) * 0x02;
+	payload.at(4) = (plant.zone1Target + 0x10) * 0x02;
+	payload.at(5) = (plant.zone2Target + 0x10) * 0x02;
+	if (longFrame) {
+		payload.at(6) = payload.at(3);
+		payload.at(7) = payload.at(4);
+		payload.at(8) = payload.at(5);
+		return makeFrame(FRAME_TYPE_STATUS, STATUS_SRC, STATUS_DST, FRAME_DATA_TYPE_STATUS, payload);
+	}
+	return makeFrame(FRAME_TYPE_UPDATE, STATUS_SRC, STATUS_DST, FRAME_DATA_TYPE_STATUS, payload);
+}
+
+void EstiaBusSim::schedule() {
+	schedule(clock.uptimeUs());
+}
+
+// periodic frames up to `untilUs`, replies up to now
+void EstiaBusSim::schedule(uint64_t untilUs) {
+	uint64_t now = clock.uptimeUs();
+	while (nextHeartbeatUs <= untilUs) {
+		transmit(makeFrame(FRAME_TYPE_CTRL_FRAME, FRAME_SRC_DST_MASTER, FRAME_SRC_DST_BROADCAST, FRAME_DATA_TYPE_HEARTBEAT, {}), nextHeartbeatUs);
+		nextHeartbeatUs += MS_TO_US(config.heartbeatPeriodMs);
+	}
+	while (nextStatusUs <= untilUs) {
+		transmit(statusFrame(true), nextStatusUs);
+		nextStatusUs += MS_TO_US(config.statusPeriodMs);
+	}
+	while (nextShortStatusUs <= untilUs) {
+		FrameBuffer payload(FRAME_SHORT_STATUS_LEN - FRAME_MIN_LEN, 0x00);
+		transmit(makeFrame(FRAME_TYPE_STATUS, STATUS_SRC, STATUS_DST, FRAME_DATA_TYPE_SHORT_STATUS, payload), nextShortStatusUs);
+		nextShortStatusUs += MS_TO_US(config.shortStatusPeriodMs);
+	}
+	while (nextRemoteStatusUs <= untilUs) {
+		FrameBuffer payload(FRAME_STATUS2_LEN - FRAME_MIN_LEN, 0x00);
+		transmit(makeFrame(FRAME_TYPE_STATUS2, FRAME_SRC_DST_REMOTE, FRAME_SRC_DST_MASTER, FRAME_DATA_TYPE_STATUS, payload), nextRemoteStatusUs);
+		nextRemoteStatusUs += MS_TO_US(config.remoteStatusPeriodMs);
+	}
+	while (nextUpdateUs <= untilUs) {
+		transmit(statusFrame(false), nextUpdateUs);
+		nextUpdateUs += MS_TO_US(config.updatePeriodMs);
+	}
+	while (!replies.empty() && replies.front().first <= now) {
+		transmit(replies.front().second, replies.front().first);
+		replies.pop_front();
+	}
+}
+
+// master/remote frame: waits for a free wire, then goes through the fault injection
+void EstiaBusSim::transmit(const FrameBuffer& frame, uint64_t startUs) {
+	uint64_t busyUs = config.carrierSense ? wireBusyUntilUs : masterBusyUntilUs;
+	uint64_t atUs = startUs > busyUs ? startUs : busyUs;
+	bool damaged = false;
+	for (auto byte : frame) {
+		atUs += ESTIA_SIM_BYTE_US;
+		if (chance(config.dropRate)) {
+			stats.droppedBytes++;
+			damaged = true;
+			continue;
+		}
+		if (chance(config.corruptRate)) {
+			byte ^= 1 << (rng() % 8);
+			stats.corruptedBytes++;
+			damaged = true;
+		}
+		place(byte, atUs);
+	}
+	if (atUs > wireBusyUntilUs) { wireBusyUntilUs = atUs; }
+	masterBusyUntilUs = atUs;
+	stats.masterFrames++;
+	if (damaged) { stats.damagedFrames++; }
+}
+
+void EstiaBusSim::place(uint8_t byte, uint64_t atUs) {
+	auto it = rx.end();
+	while (it != rx.begin() && (it - 1)->atUs > atUs) {
+		--it;
+	}
+	rx.insert(it, {atUs, byte});
+}
+
+void EstiaBusSim::handleNodeFrame(const FrameBuffer& frame, uint64_t endUs) {
+	if (frame.size() < FRAME_MIN_LEN || EstiaFrame::readUint16(frame, 0) != FRAME_BEGIN) { return; }
+	if (static_cast<size_t>(frame.at(FRAME_DATA_LEN_OFFSET) + FRAME_HEAD_AND_CRC_LEN) != frame.size()) { return; }
+	if (EstiaFrame::readUint16(frame, frame.size() - 2) != EstiaFrame::crc16(frame.data(), frame.size() - 2)) { return; }
+
+	uint16_t dataType = EstiaFrame::readUint16(frame, FRAME_DATA_TYPE_OFFSET);
+	uint64_t replyUs;
+	FrameBuffer reply;
+	if (frame.at(FRAME_TYPE_OFFSET) == FRAME_TYPE_REQ_DATA && dataType == FRAME_DATA_TYPE_DATA_REQUEST
+	    && frame.size() == FRAME_REQ_DATA_LEN) {
+		uint8_t code = frame.at(REQ_DATA_CODE_OFFSET);
+		stats.requests++;
+		if (config.silentCodes.count(code) != 0) { return; }
+		bool empty = config.emptyCodes.count(code) != 0;
+		int16_t value = empty ? 0 : sensorValue(code);
+		FrameBuffer payload = {0x00, 0x80, 0x00, 0x00, 0x00, 0x00};
+		EstiaFrame::writeUint16(payload, RES_DATA_EMPTY_OFFSET - FRAME_DATA_OFFSET, empty ? RES_DATA_FLAG_EMPTY : RES_DATA_FLAG_NOT_EMPTY);
+		EstiaFrame::writeUint16(payload, RES_DATA_VALUE_OFFSET - FRAME_DATA_OFFSET, value);
+		reply = makeFrame(FRAME_TYPE_RES_DATA, RES_DATA_SRC, RES_DATA_DST, FRAME_DATA_TYPE_DATA_RESPONSE, payload);
+		replyUs = endUs + MS_TO_US(config.responseDelayMs);
+		stats.responses++;
+		if (empty) { stats.emptyResponses++; }
+	} else if (frame.at(FRAME_TYPE_OFFSET) == FRAME_TYPE_CMD) {
+		applyCommand(frame);
+		FrameBuffer payload = {static_cast<uint8_t>(dataType >> 8), static_cast<uint8_t>(dataType & 0xff)};
+		reply = makeFrame(FRAME_TYPE_ACK, ACK_SRC, FRAME_SRC_DST_REMOTE, FRAME_DATA_TYPE_ACK, payload);
+		replyUs = endUs + MS_TO_US(config.ackDelayMs);
+		stats.commands++;
+		stats.acks++;
+		// master broadcasts the new state shortly after acking
+		uint64_t updateUs = replyUs + MS_TO_US(200);
+		if (updateUs < nextUpdateUs) { nextUpdateUs = updateUs; }
+	} else {
+		return;
+	}
+	auto it = replies.end();
+	while (it != replies.begin() && (it - 1)->first > replyUs) {
+		--it;
+	}
+	replies.insert(it, {replyUs, reply});
+}
+
+void EstiaBusSim::applyCommand(const FrameBuffer& frame) {
+	uint8_t value = frame.at(FRAME_DATA_OFFSET);
+	switch (EstiaFrame::readUint16(frame, FRAME_DATA_TYPE_OFFSET)) {
+	case FRAME_DATA_TYPE_OPERATION_SWITCH:
+		if ((value & 0xfe) == SWITCH_OPERATION_COOL_HEAT) { plant.zoneOn = value & 0x01; }
+		if ((value & 0xfb) == SWITCH_OPERATION_HOT_WATER) { plant.hotWater = (value & 0x04) != 0; }
+		break;
+
+	case FRAME_DATA_TYPE_OPERATION_MODE:
+		plant.operationMode = value;
+		break;
+
+	case FRAME_DATA_TYPE_MODE_CHANGE:
+		if (value == SET_AUTO_MODE_CODE) { plant.autoMode = frame.at(SET_MODE_VALUE_OFFSET) != 0; }
+		if (value == SET_QUIET_MODE_CODE) { plant.quietMode = frame.at(SET_MODE_VALUE_OFFSET) != 0; }
+		if (value == SET_NIGHT_MODE_CODE) { plant.nightMode = frame.at(SET_MODE_VALUE_OFFSET) != 0; }
+		break;
+
+	case FRAME_DATA_TYPE_TEMPERATURE_CHANGE:
+		if (value == TEMPERATURE_HOT_WATER_CODE) {
+			plant.hotWaterTarget = frame.at(TEMPERATURE_HOT_WATER_VALUE_OFFSET) / 0x02 - 0x10;
+		} else {
+			plant.zone1Target = frame.at(TEMPERATURE_ZONE1_VALUE_OFFSET) / 0x02 - 0x10;
+			plant.zone2Target = frame.at(TEMPERATURE_ZONE2_VALUE_OFFSET) / 0x02 - 0x10;
+		}
+		break;
+	}
+}
+
+// slow random walk around a per-code base value
+int16_t EstiaBusSim::sensorValue(uint8_t code) {
+	auto it = values.find(code);
+	if (it == values.end()) {
+		it = values.emplace(code, static_cast<int16_t>(20 + code % 23)).first;
+	}
+	it->second += static_cast<int16_t>(rng() % 3) - 1;
+	return it->second;
+}
+
+int EstiaBusSim::available() {
+	schedule();
+	uint64_t now = clock.uptimeUs();
+	int count = 0;
+	for (auto& byte : rx) {
+		if (byte.atUs > now) { break; }
+		count++;
+	}
+	return count;
+}
+
+uint8_t EstiaBusSim::read() {
+	schedule();
+	if (rx.empty() || rx.front().atUs > clock.uptimeUs()) { return 0x00; }
+
+	uint8_t value = rx.front().value;
+	rx.pop_front();
+	return value;
+}
+
+// node frame: goes on the wire immediately (no carrier sense), bytes that
+// overlap other traffic are wired-AND'ed together on both sides
+void EstiaBusSim::write(const uint8_t* data, size_t len) {
+	uint64_t startUs = clock.uptimeUs();
+	// a master that doesn't listen starts its periodic frames on time, on top of ours
+	schedule(config.carrierSense ? startUs : startUs + len * ESTIA_SIM_BYTE_US);
+	if (chance(config.collisionRate)) {
+		FrameBuffer payload(FRAME_STATUS2_LEN - FRAME_MIN_LEN, 0x00);
+		FrameBuffer remote = makeFrame(FRAME_TYPE_STATUS2, FRAME_SRC_DST_REMOTE, FRAME_SRC_DST_MASTER, FRAME_DATA_TYPE_STATUS, payload);
+		uint64_t atUs = startUs;
+		for (auto byte : remote) {
+			atUs += ESTIA_SIM_BYTE_US;
+			place(byte, atUs);
+		}
+		stats.masterFrames++;
+		if (atUs > wireBusyUntilUs) { wireBusyUntilUs = atUs; }
+		if (atUs > masterBusyUntilUs) { masterBusyUntilUs = atUs; }
+	}
+
+	FrameBuffer onWire(data, data + len);
+	bool collided = false;
+	uint64_t atUs = startUs;
+	for (size_t idx = 0; idx < len; idx++) {
+		atUs += ESTIA_SIM_BYTE_US;
+		auto it = rx.begin();
+		while (it != rx.end() && it->atUs + ESTIA_SIM_BYTE_US <= atUs) {
+			++it;
+		}
+		if (it != rx.end() && it->atUs < atUs + ESTIA_SIM_BYTE_US) {
+			it->value &= data[idx];
+			onWire.at(idx) = it->value;
+			collided = true;
+			continue;
+		}
+		if (config.echo) { place(data[idx], atUs); }
+	}
+	if (collided) {
+		stats.collisions++;
+		stats.damagedFrames++;
+	}
+	stats.nodeFrames++;
+	nodeTxEndUs = atUs;
+	if (atUs > wireBusyUntilUs) { wireBusyUntilUs = atUs; }
+	handleNodeFrame(onWire, atUs);
+}
+
+void EstiaBusSim::flush() {
+	clock.advanceTo(nodeTxEndUs);
+}
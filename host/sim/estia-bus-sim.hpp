@@ -0,0 +1,133 @@
+/*
+estia-bus-sim.hpp - simulated Estia R32 master/remote bus
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "estia-hal.hpp"
+#include "frame.hpp"
+#include "sim-clock.hpp"
+#include <deque>
+#include <map>
+#include <random>
+#include <set>
+
+#define ESTIA_SIM_BAUD 2400
+#define ESTIA_SIM_BITS_PER_BYTE 11    // 8E1: start + 8 data + parity + stop
+#define ESTIA_SIM_BYTE_US (1000000ULL * ESTIA_SIM_BITS_PER_BYTE / ESTIA_SIM_BAUD)
+
+struct SimBusConfig {
+	uint32_t seed = 1;
+	uint32_t heartbeatPeriodMs = 1000;
+	uint32_t statusPeriodMs = 30000;            // long status broadcast
+	uint32_t shortStatusPeriodMs = 1800000;     // short status broadcast
+	uint32_t remoteStatusPeriodMs = 30000;      // remote STATUS2 frame
+	uint32_t updatePeriodMs = 10000;            // status update frame
+	uint32_t responseDelayMs = 40;              // request end -> response start
+	uint32_t ackDelayMs = 60;                   // command end -> ack start
+	double corruptRate = 0.0;                   // per byte, flip one random bit
+	double dropRate = 0.0;                      // per byte, byte never arrives
+	double collisionRate = 0.0;                 // per node TX, remote starts talking at the same time
+	bool echo = true;                           // node TX loops back onto its RX
+	bool carrierSense = true;                   // periodic master frames wait for node TX to end
+	bool pump1 = true;
+	std::set<uint8_t> emptyCodes;               // request codes answered with RES_DATA_FLAG_EMPTY
+	std::set<uint8_t> silentCodes;              // request codes never answered, a dead sensor
+};
+
+struct SimBusStats {
+	uint32_t masterFrames = 0;      // frames put on the wire by master/remote
+	uint32_t damagedFrames = 0;     // ... of which at least one byte was corrupted, dropped or collided
+	uint32_t nodeFrames = 0;        // frames written by the node under test
+	uint32_t requests = 0;          // valid DataReqFrame received by master
+	uint32_t responses = 0;
+	uint32_t emptyResponses = 0;
+	uint32_t commands = 0;          // valid command frames received by master
+	uint32_t acks = 0;
+	uint32_t collisions = 0;
+	uint32_t corruptedBytes = 0;
+	uint32_t droppedBytes = 0;
+};
+
+/**
+* Local stand-in for the heat pump side of the Tu2C bus.
+*
+* Implements `EstiaUart` for the node under test: everything the master and
+* remote put on the wire, and the node's own echoed TX, arrives on RX at
+* 2400 baud 8E1 byte times measured on the shared `SimClock`. Requests are
+* answered with `DataResFrame` values, commands are acked and applied.
+* Without `carrierSense` the periodic frames keep their cadence and collide
+* with node TX that overlaps them, like a master that doesn't listen first.
+*/
+class EstiaBusSim : public EstiaUart {
+  private:
+	struct WireByte {
+		uint64_t atUs;
+		uint8_t value;
+	};
+	struct PlantState {
+		uint8_t operationMode;
+		bool zoneOn;
+		bool hotWater;
+		bool autoMode;
+		bool quietMode;
+		bool nightMode;
+		bool pump1;
+		uint8_t hotWaterTarget;
+		uint8_t zone1Target;
+		uint8_t zone2Target;
+	};
+
+	SimClock& clock;
+	SimBusConfig config;
+	std::mt19937 rng;
+	std::deque<WireByte> rx;
+	uint64_t wireBusyUntilUs;
+	uint64_t masterBusyUntilUs;
+	uint64_t nodeTxEndUs;
+	uint64_t nextHeartbeatUs;
+	uint64_t nextStatusUs;
+	uint64_t nextShortStatusUs;
+	uint64_t nextRemoteStatusUs;
+	uint64_t nextUpdateUs;
+	std::deque<std::pair<uint64_t, FrameBuffer>> replies;    // master answers waiting for their slot
+	std::map<uint8_t, int16_t> values;
+	PlantState plant;
+
+	bool chance(double rate);
+	FrameBuffer statusFrame(bool longFrame);
+	void schedule();
+	void schedule(uint64_t untilUs);
+	void transmit(const FrameBuffer& frame, uint64_t startUs);
+	void place(uint8_t byte, uint64_t atUs);
+	void handleNodeFrame(const FrameBuffer& frame, uint64_t endUs);
+	void applyCommand(const FrameBuffer& frame);
+	int16_t sensorValue(uint8_t code);
+
+  public:
+	EstiaBusSim(SimClock& clock, const SimBusConfig& config = SimBusConfig());
+
+	SimBusStats stats;
+
+	void setValue(uint8_t code, int16_t value);
+	static FrameBuffer makeFrame(uint8_t type, uint16_t src, uint16_t dst, uint16_t dataType, const FrameBuffer& payload);
+
+	int available() override;
+	uint8_t read() override;
+	void write(const uint8_t* data, size_t len) override;
+	void flush() override;
+};
@@ -0,0 +1,452 @@
+/*
+estia-decode.cpp - decode bus captures into columnar sensor and status tables
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "data-frames.hpp"
+#include "frame-classifier.hpp"
+#include "frame-fixer.hpp"
+#include "frame-pool.hpp"
+#include "frame-sync.hpp"
+#include "host-capture.hpp"
+#include "status-frames.hpp"
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+* Usage: estia-decode [--threads N] [--csv PREFIX] [--columns PREFIX] capture...
+*
+* Decodes `BusCapture` streams (`estia-sim --capture` or dumps of the capture
+* partition) with the on-device pipeline: every RX record goes through
+* `FrameSync`, `FrameFixer`, `FrameClassifier` and the frame decoders, sent
+* data requests pair the next data response with its request code. Files are
+* memory-mapped and decoded in parallel, one file per thread at a time; the
+* output keeps the order of the command line.
+*
+* Two tables come out, keyed by capture time (µs since the first record of
+* the file, `micros()` wraps unrolled) and file index:
+*
+*     PREFIX-status   one row per decoded status or status update frame
+*     PREFIX-sensors  one row per data response, value scaled by requestsMap
+*
+* `--csv` writes them as `.csv`, `--columns` as `.col`, a binary columnar
+* file, little endian:
+*
+*     char[4] "ESTC", u8 version (1), u8 column count, u16 0, u64 row count
+*     per column:  u8 type, u8 name length, name
+*     per column:  row count values, 1 u8, 2 u16, 3 i16, 4 u64, 5 f32
+*/
+
+#define DECODE_NO_REQUEST -1
+
+enum ColumnType : uint8_t {
+	col_u8 = 1,
+	col_u16,
+	col_i16,
+	col_u64,
+	col_f32,
+};
+
+struct StatusRow {
+	uint64_t timestampUs;
+	uint16_t file;
+	StatusData data;
+};
+
+struct SensorRow {
+	uint64_t timestampUs;
+	uint16_t file;
+	uint8_t code;
+	uint8_t error;    // EstiaFrame error, err_ok when `raw` is a value
+	int16_t raw;
+};
+
+struct FileResult {
+	std::vector<StatusRow> status;
+	std::vector<SensorRow> sensors;
+	size_t bytes = 0;
+	uint32_t records = 0;
+	uint32_t frames = 0;
+	uint32_t crcErrors = 0;
+	bool ok = false;
+};
+
+struct SensorName {
+	const char* name;
+	float multiplier;
+};
+static SensorName sensorNames[256];
+
+/**
+* Replays one capture through the sniffer pipeline without the request
+* engine, so traffic of any master on the bus is decoded.
+*/
+class CaptureDecoder {
+  private:
+	SniffedFrames frames;
+	FrameSync frameSync;
+	FrameFixer frameFixer;
+	FrameClassifier frameClassifier;
+	FileResult& result;
+	uint16_t file;
+	uint64_t nowUs;
+	uint32_t previous;
+	bool started;
+	int16_t requestCode;    // last data request sent, DECODE_NO_REQUEST once answered
+
+	void decode();
+
+  public:
+	CaptureDecoder(FileResult& result, uint16_t file)
+	    : frames()
+	    , frameSync(frames)
+	    , frameFixer()
+	    , frameClassifier()
+	    , result(result)
+	    , file(file)
+	    , nowUs(0)
+	    , previous(0)
+	    , started(false)
+	    , requestCode(DECODE_NO_REQUEST) {}
+
+	void record(const CaptureRecord& record);
+};
+
+void CaptureDecoder::record(const CaptureRecord& record) {
+	result.records++;
+	if (started) { nowUs += record.timestamp - previous; }
+	previous = record.timestamp;
+	started = true;
+
+	if (record.tx()) {
+		if (record.length > REQ_DATA_CODE_OFFSET && record.data[FRAME_TYPE_OFFSET] == FRAME_TYPE_REQ_DATA) {
+			requestCode = record.data[REQ_DATA_CODE_OFFSET];
+		}
+		return;
+	}
+	// one RX record is one frame as the device framed it, flushing keeps the
+	// boundary where the frame gap put it
+	for (uint8_t idx = 0; idx < record.length; idx++) {
+		frameSync.push(record.data[idx]);
+	}
+	frameSync.flush();
+	this->decode();
+}
+
+void CaptureDecoder::decode() {
+	FrameClass* frameClass;
+	while (FrameBuffer* frame = frames.nextUndecoded(&frameClass)) {
+		result.frames++;
+		bool crcValid = frameFixer.fixFrame(*frame);
+		if (!crcValid) { result.crcErrors++; }
+		FrameView view(*frame);
+		*frameClass = frameClassifier.classify(view, crcValid);
+		switch (frameClass->kind) {
+			case frame_status:
+			case frame_status_update:
+				if (frameClass->valid()) { result.status.push_back({nowUs, file, StatusFrame::decodeUnchecked(view)}); }
+				break;
+			case frame_data_response: {
+				if (requestCode == DECODE_NO_REQUEST) { break; }
+				DataResponse response = {frameClass->error, 0};
+				if (frameClass->valid()) { response = DataResFrame::decodeUnchecked(view); }
+				result.sensors.push_back({nowUs, file, static_cast<uint8_t>(requestCode), response.error, response.value});
+				requestCode = DECODE_NO_REQUEST;
+				break;
+			}
+			default:
+				break;
+		}
+	}
+	while (!frames.empty()) {
+		frames.pop();
+	}
+}
+
+static bool decodeFile(const char* path, uint16_t file, FileResult& result) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) { return false; }
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return false;
+	}
+	result.bytes = info.st_size;
+	if (info.st_size == 0) {
+		close(fd);
+		return true;
+	}
+	void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED) { return false; }
+	madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+
+	// a flash dump wraps, decode from its oldest sector to the end, then the start
+	const uint8_t* data = static_cast<const uint8_t*>(mapped);
+	size_t oldest = CaptureReader::oldestSector(data, info.st_size);
+	CaptureDecoder decoder(result, file);
+	auto visit = [&](const CaptureRecord& record) { decoder.record(record); };
+	CaptureReader::each(data + oldest, info.st_size - oldest, visit);
+	CaptureReader::each(data, oldest, visit);
+	munmap(mapped, info.st_size);
+	return true;
+}
+
+class ColumnFile {
+  private:
+	FILE* out;
+	std::vector<uint8_t> column;
+
+	template <typename T>
+	void put(T value) {
+		uint8_t bytes[sizeof(T)];
+		memcpy(bytes, &value, sizeof(T));    // hosts are little endian
+		column.insert(column.end(), bytes, bytes + sizeof(T));
+	}
+
+  public:
+	ColumnFile(FILE* out, uint8_t columns, uint64_t rows)
+	    : out(out)
+	    , column() {
+		const uint8_t header[8] = {'E', 'S', 'T', 'C', 1, columns, 0, 0};
+		fwrite(header, 1, sizeof(header), out);
+		fwrite(&rows, sizeof(rows), 1, out);
+	}
+
+	void describe(ColumnType type, const char* name) {
+		uint8_t head[2] = {type, static_cast<uint8_t>(strlen(name))};
+		fwrite(head, 1, sizeof(head), out);
+		fwrite(name, 1, head[1], out);
+	}
+
+	// values of one column for every row, in the declared type
+	template <typename Row, typename Get>
+	void write(ColumnType type, const std::vector<Row>& rows, Get get) {
+		column.clear();
+		for (const Row& row : rows) {
+			switch (type) {
+				case col_u8: put<uint8_t>(get(row)); break;
+				case col_u16: put<uint16_t>(get(row)); break;
+				case col_i16: put<int16_t>(get(row)); break;
+				case col_u64: put<uint64_t>(get(row)); break;
+				case col_f32: put<float>(get(row)); break;
+			}
+		}
+		fwrite(column.data(), 1, column.size(), out);
+	}
+};
+
+struct StatusField {
+	const char* name;
+	uint8_t (*get)(const StatusData& data);
+};
+
+static const StatusField statusFields[] = {
+    {"error", [](const StatusData& data) -> uint8_t { return data.error; }},
+    {"operation_mode", [](const StatusData& data) -> uint8_t { return data.operationMode; }},
+    {"extended", [](const StatusData& data) -> uint8_t { return data.extendedData; }},
+    {"cooling", [](const StatusData& data) -> uint8_t { return data.cooling; }},
+    {"heating", [](const StatusData& data) -> uint8_t { return data.heating; }},
+    {"hot_water", [](const StatusData& data) -> uint8_t { return data.hotWater; }},
+    {"auto_mode", [](const StatusData& data) -> uint8_t { return data.autoMode; }},
+    {"quiet_mode", [](const StatusData& data) -> uint8_t { return data.quietMode; }},
+    {"night_mode", [](const StatusData& data) -> uint8_t { return data.nightMode; }},
+    {"backup_heater", [](const StatusData& data) -> uint8_t { return data.backupHeater; }},
+    {"cooling_cmp", [](const StatusData& data) -> uint8_t { return data.coolingCMP; }},
+    {"heating_cmp", [](const StatusData& data) -> uint8_t { return data.heatingCMP; }},
+    {"hot_water_heater", [](const StatusData& data) -> uint8_t { return data.hotWaterHeater; }},
+    {"hot_water_cmp", [](const StatusData& data) -> uint8_t { return data.hotWaterCMP; }},
+    {"pump1", [](const StatusData& data) -> uint8_t { return data.pump1; }},
+    {"hot_water_target", [](const StatusData& data) -> uint8_t { return data.hotWaterTarget; }},
+    {"zone1_target", [](const StatusData& data) -> uint8_t { return data.zone1Target; }},
+    {"zone2_target", [](const StatusData& data) -> uint8_t { return data.zone2Target; }},
+    {"hot_water_target2", [](const StatusData& data) -> uint8_t { return data.extendedData ? data.hotWaterTarget2 : 0; }},
+    {"zone1_target2", [](const StatusData& data) -> uint8_t { return data.extendedData ? data.zone1Target2 : 0; }},
+    {"zone2_target2", [](const StatusData& data) -> uint8_t { return data.extendedData ? data.zone2Target2 : 0; }},
+    {"defrost_in_progress", [](const StatusData& data) -> uint8_t { return data.extendedData && data.defrostInProgress; }},
+    {"night_mode_active", [](const StatusData& data) -> uint8_t { return data.extendedData && data.nightModeActive; }},
+};
+static const uint8_t statusFieldCount = sizeof(statusFields) / sizeof(statusFields[0]);
+
+static float sensorValue(const SensorRow& row) {
+	return row.error == EstiaFrame::err_ok ? row.raw * sensorNames[row.code].multiplier : 0;
+}
+
+static FILE* openOutput(const std::string& prefix, const char* table, const char* extension) {
+	std::string path = prefix + "-" + table + extension;
+	FILE* out = fopen(path.c_str(), "wb");
+	if (!out) { perror(path.c_str()); }
+	return out;
+}
+
+static bool writeCsv(const std::string& prefix, const std::vector<StatusRow>& status, const std::vector<SensorRow>& sensors) {
+	FILE* out = openOutput(prefix, "status", ".csv");
+	if (!out) { return false; }
+	fputs("timestamp_us,file", out);
+	for (const StatusField& field : statusFields) {
+		fprintf(out, ",%s", field.name);
+	}
+	fputc('\n', out);
+	for (const StatusRow& row : status) {
+		fprintf(out, "%llu,%u", static_cast<unsigned long long>(row.timestampUs), row.file);
+		for (const StatusField& field : statusFields) {
+			fprintf(out, ",%u", field.get(row.data));
+		}
+		fputc('\n', out);
+	}
+	fclose(out);
+
+	out = openOutput(prefix, "sensors", ".csv");
+	if (!out) { return false; }
+	fputs("timestamp_us,file,code,name,error,raw,value\n", out);
+	for (const SensorRow& row : sensors) {
+		const char* name = sensorNames[row.code].name ? sensorNames[row.code].name : "";
+		fprintf(out, "%llu,%u,%u,%s,%u,%d,", static_cast<unsigned long long>(row.timestampUs), row.file, row.code,
+		        name, row.error, row.raw);
+		if (row.error == EstiaFrame::err_ok) { fprintf(out, "%g", sensorValue(row)); }
+		fputc('\n', out);
+	}
+	fclose(out);
+	return true;
+}
+
+static bool writeColumns(const std::string& prefix, const std::vector<StatusRow>& status, const std::vector<SensorRow>& sensors) {
+	FILE* out = openOutput(prefix, "status", ".col");
+	if (!out) { return false; }
+	ColumnFile statusFile(out, 2 + statusFieldCount, status.size());
+	statusFile.describe(col_u64, "timestamp_us");
+	statusFile.describe(col_u16, "file");
+	for (const StatusField& field : statusFields) {
+		statusFile.describe(col_u8, field.name);
+	}
+	statusFile.write(col_u64, status, [](const StatusRow& row) { return row.timestampUs; });
+	statusFile.write(col_u16, status, [](const StatusRow& row) { return row.file; });
+	for (const StatusField& field : statusFields) {
+		statusFile.write(col_u8, status, [&](const StatusRow& row) { return field.get(row.data); });
+	}
+	fclose(out);
+
+	out = openOutput(prefix, "sensors", ".col");
+	if (!out) { return false; }
+	ColumnFile sensorFile(out, 6, sensors.size());
+	sensorFile.describe(col_u64, "timestamp_us");
+	sensorFile.describe(col_u16, "file");
+	sensorFile.describe(col_u8, "code");
+	sensorFile.describe(col_u8, "error");
+	sensorFile.describe(col_i16, "raw");
+	sensorFile.describe(col_f32, "value");
+	sensorFile.write(col_u64, sensors, [](const SensorRow& row) { return row.timestampUs; });
+	sensorFile.write(col_u16, sensors, [](const SensorRow& row) { return row.file; });
+	sensorFile.write(col_u8, sensors, [](const SensorRow& row) { return row.code; });
+	sensorFile.write(col_u8, sensors, [](const SensorRow& row) { return row.error; });
+	sensorFile.write(col_i16, sensors, [](const SensorRow& row) { return row.raw; });
+	sensorFile.write(col_f32, sensors, sensorValue);
+	fclose(out);
+	return true;
+}
+
+int main(int argc, char** argv) {
+	unsigned threads = std::thread::hardware_concurrency();
+	const char* csvPrefix = nullptr;
+	const char* columnsPrefix = nullptr;
+	std::vector<const char*> paths;
+	for (int idx = 1; idx < argc; idx++) {
+		const char* arg = argv[idx];
+		if (arg[0] != '-') {
+			paths.push_back(arg);
+			continue;
+		}
+		if (idx + 1 >= argc) {
+			fprintf(stderr, "%s: missing value\n", arg);
+			return 1;
+		}
+		const char* value = argv[++idx];
+		if (strcmp(arg, "--threads") == 0) {
+			threads = strtoul(value, nullptr, 0);
+		} else if (strcmp(arg, "--csv") == 0) {
+			csvPrefix = value;
+		} else if (strcmp(arg, "--columns") == 0) {
+			columnsPrefix = value;
+		} else {
+			fprintf(stderr, "unknown option %s\n", arg);
+			return 1;
+		}
+	}
+	if (paths.empty() || paths.size() > UINT16_MAX) {
+		fprintf(stderr, "usage: estia-decode [--threads N] [--csv PREFIX] [--columns PREFIX] capture...\n");
+		return 1;
+	}
+	if (threads == 0) { threads = 1; }
+	if (threads > paths.size()) { threads = paths.size(); }
+	for (const auto& entry : requestsMap) {
+		sensorNames[entry.second.code] = {entry.first.c_str(), entry.second.multiplier};
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<FileResult> results(paths.size());
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> workers;
+	for (unsigned worker = 0; worker < threads; worker++) {
+		workers.emplace_back([&] {
+			for (size_t file = next++; file < paths.size(); file = next++) {
+				results[file].ok = decodeFile(paths[file], file, results[file]);
+			}
+		});
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<StatusRow> status;
+	std::vector<SensorRow> sensors;
+	size_t bytes = 0;
+	uint32_t records = 0;
+	uint32_t frames = 0;
+	uint32_t crcErrors = 0;
+	int exitCode = 0;
+	for (size_t file = 0; file < paths.size(); file++) {
+		FileResult& result = results[file];
+		if (!result.ok) {
+			perror(paths[file]);
+			exitCode = 1;
+			continue;
+		}
+		status.insert(status.end(), result.status.begin(), result.status.end());
+		sensors.insert(sensors.end(), result.sensors.begin(), result.sensors.end());
+		bytes += result.bytes;
+		records += result.records;
+		frames += result.frames;
+		crcErrors += result.crcErrors;
+	}
+	if (csvPrefix && !writeCsv(csvPrefix, status, sensors)) { exitCode = 1; }
+	if (columnsPrefix && !writeColumns(columnsPrefix, status, sensors)) { exitCode = 1; }
+
+	fprintf(stderr, "%zu files, %.1f MB, %u records, %u frames (%u crc errors), %zu status, %zu sensor values\n",
+	        paths.size(), bytes / 1e6, records, frames, crcErrors, status.size(), sensors.size());
+	fprintf(stderr, "decoded in %.3f s on %u threads, %.1f MB/s\n", seconds, threads, bytes / 1e6 / seconds);
+	return exitCode;
+}
@@ -0,0 +1,57 @@
+/*
+estia-logdump.cpp - decoder for serialized binary log records
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "binary-log.hpp"
+#include <stdio.h>
+#include <vector>
+
+/**
+* Usage: estia-logdump [record-file]
+*
+* Formats serialized `LogRecord`s (stdin when no file given), one line per
+* record, the same text the device prints when it drains its `BinaryLog`.
+*/
+int main(int argc, char** argv) {
+	FILE* input = argc > 1 ? fopen(argv[1], "rb") : stdin;
+	if (!input) {
+		perror(argv[1]);
+		return 1;
+	}
+
+	std::vector<uint8_t> data;
+	uint8_t chunk[4096];
+	size_t len;
+	while ((len = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+		data.insert(data.end(), chunk, chunk + len);
+	}
+	if (input != stdin) { fclose(input); }
+
+	LogRecord record;
+	char line[BINARY_LOG_LINE_SIZE];
+	size_t offset = 0;
+	while (size_t used = LogRecord::deserialize(data.data() + offset, data.size() - offset, record)) {
+		record.format(line, sizeof(line));
+		printf("%s\n", line);
+		offset += used;
+	}
+	if (offset != data.size()) {
+		fprintf(stderr, "%zu trailing bytes\n", data.size() - offset);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,359 @@
+/*
+estia-sim.cpp - run EstiaSerial against the simulated Estia bus
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "binary-log.hpp"
+#include "capture-codec.hpp"
+#include "estia-bus-sim.hpp"
+#include "estia-serial.hpp"
+#include "host-capture.hpp"
+#include "request-scheduler.hpp"
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/**
+* Usage: estia-sim [--hours H] [--seed N] [--corrupt P] [--drop P] [--collide P]
+*                  [--loop-ms MS] [--cmd-interval S] [--empty CODE] [--no-echo]
+*                  [--silent CODE] [--no-carrier-sense]
+*                  [--log FILE] [--capture FILE] [--codec]
+*                  [--scheduler] [--max-age NAME=MS]
+*
+* Drives `EstiaSerial` the way `ToshibaLog::loop()` does (one `sniffer()` call
+* per ESPHome loop, sensor cycle after every long status frame, a mode command
+* every `--cmd-interval` seconds) against `EstiaBusSim` on a `SimClock`, and
+* reports sensor-cycle time, command latency and frame recovery. `--log`
+* writes the status and ack records `ToshibaLog` would log, serialized, for
+* `estia-logdump`. `--capture` records every sniffed and sent frame the way
+* `capture: flash` does, for `estia-sniff --capture`, `--codec` encodes it
+* with `CaptureCodec`.
+*
+* `--scheduler` replaces the sensor cycle with `RequestScheduler`, one
+* request per free slot as `ToshibaLog` does, `--max-age` sets the target of
+* one sensor (30 s by default). Either way the refresh interval of every
+* sensor, the response times `RequestTiming` learned and the master cadence
+* `BusTiming` learned are reported. `--no-carrier-sense` lets periodic
+* master frames collide with node TX instead of waiting for it.
+*/
+
+struct Series {
+	std::vector<uint32_t> samples;
+
+	void add(uint32_t sample) { samples.push_back(sample); }
+	void print(const char* name) {
+		if (samples.empty()) {
+			printf("%-22s n=0\n", name);
+			return;
+		}
+		std::sort(samples.begin(), samples.end());
+		uint64_t sum = 0;
+		for (auto sample : samples) {
+			sum += sample;
+		}
+		printf("%-22s n=%zu min=%u avg=%llu p50=%u p95=%u max=%u ms\n", name, samples.size(), samples.front(),
+		       static_cast<unsigned long long>(sum / samples.size()), samples.at(samples.size() / 2),
+		       samples.at(samples.size() * 95 / 100), samples.back());
+	}
+};
+
+int main(int argc, char** argv) {
+	SimBusConfig config;
+	double hours = 24;
+	uint32_t loopMs = 16;
+	uint32_t cmdIntervalS = 600;
+	FILE* logFile = nullptr;
+	FILE* captureFile = nullptr;
+	bool codec = false;
+	bool scheduled = false;
+	std::map<std::string, uint32_t> maxAges;
+	for (int idx = 1; idx < argc; idx++) {
+		const char* arg = argv[idx];
+		const char* value = idx + 1 < argc ? argv[idx + 1] : nullptr;
+		if (strcmp(arg, "--no-echo") == 0) {
+			config.echo = false;
+			continue;
+		}
+		if (strcmp(arg, "--no-carrier-sense") == 0) {
+			config.carrierSense = false;
+			continue;
+		}
+		if (strcmp(arg, "--codec") == 0) {
+			codec = true;
+			continue;
+		}
+		if (strcmp(arg, "--scheduler") == 0) {
+			scheduled = true;
+			continue;
+		}
+		if (!value) {
+			fprintf(stderr, "%s: missing value\n", arg);
+			return 1;
+		}
+		idx++;
+		if (strcmp(arg, "--hours") == 0) {
+			hours = atof(value);
+		} else if (strcmp(arg, "--seed") == 0) {
+			config.seed = strtoul(value, nullptr, 0);
+		} else if (strcmp(arg, "--corrupt") == 0) {
+			config.corruptRate = atof(value);
+		} else if (strcmp(arg, "--drop") == 0) {
+			config.dropRate = atof(value);
+		} else if (strcmp(arg, "--collide") == 0) {
+			config.collisionRate = atof(value);
+		} else if (strcmp(arg, "--loop-ms") == 0) {
+			loopMs = strtoul(value, nullptr, 0);
+		} else if (strcmp(arg, "--cmd-interval") == 0) {
+			cmdIntervalS = strtoul(value, nullptr, 0);
+		} else if (strcmp(arg, "--empty") == 0) {
+			config.emptyCodes.insert(strtoul(value, nullptr, 0));
+		} else if (strcmp(arg, "--silent") == 0) {
+			config.silentCodes.insert(strtoul(value, nullptr, 0));
+		} else if (strcmp(arg, "--max-age") == 0) {
+			const char* separator = strchr(value, '=');
+			if (!separator || SensorRegistry::ordinal(std::string(value, separator)) == SENSOR_NONE) {
+				fprintf(stderr, "%s: expected NAME=MS with a requestsMap name\n", value);
+				return 1;
+			}
+			maxAges[std::string(value, separator)] = strtoul(separator + 1, nullptr, 0);
+		} else if (strcmp(arg, "--log") == 0) {
+			logFile = fopen(value, "wb");
+			if (!logFile) {
+				perror(value);
+				return 1;
+			}
+		} else if (strcmp(arg, "--capture") == 0) {
+			captureFile = fopen(value, "wb");
+			if (!captureFile) {
+				perror(value);
+				return 1;
+			}
+		} else {
+			fprintf(stderr, "unknown option %s\n", arg);
+			return 1;
+		}
+	}
+
+	SimClock clock;
+	EstiaBusSim bus(clock, config);
+	EstiaSerial estiaSerial(bus, clock);
+	BinaryLog binaryLog;
+	BusCapture capture;
+	FileCaptureSink captureSink(captureFile);
+	CaptureCodec captureCodec;
+	if (codec) { captureSink.setCodec(&captureCodec); }
+	if (captureFile) {
+		capture.setSink(&captureSink);
+		estiaSerial.setCapture(&capture);
+	}
+
+	Series cycleTime;
+	Series cmdLatency;
+	Series sniffBlocking;
+	uint32_t cycleStart = 0;
+	bool cycleRunning = false;
+	uint32_t valuesRequested = 0;
+	uint32_t valuesValid = 0;
+	uint32_t valuesEmpty = 0;
+	uint32_t valuesFailed = 0;    // given up on, published as NAN
+	uint32_t framesSniffed = 0;
+	uint32_t framesValid = 0;
+	uint32_t statusDecoded = 0;
+	uint32_t cmdQueued = 0;
+	uint32_t cmdQueuedAt = 0;
+	bool cmdPending = false;
+	bool quiet = false;
+	uint32_t nextCmd = cmdIntervalS * 1000;
+
+	// same set of sensors in both modes
+	const SensorList& sensors = SensorRegistry::defaults();
+	RequestScheduler scheduler;
+	for (uint8_t ordinal : sensors) {
+		auto maxAge = maxAges.find(SensorRegistry::name(ordinal));
+		scheduler.add(SensorRegistry::code(ordinal), maxAge != maxAges.end() ? maxAge->second : SCHEDULER_DEFAULT_MAX_AGE);
+	}
+	int16_t inFlight = SCHEDULER_NONE;
+	bool busSeen = false;
+	bool pumpRunning = false;
+	std::vector<Series> refresh(sensors.size());
+	std::vector<uint32_t> lastRefresh(sensors.size(), 0);
+	std::vector<bool> refreshed(sensors.size(), false);
+	auto sensorUpdated = [&](size_t idx, int16_t value) {
+		valuesRequested++;
+		if (value > EstiaSerial::err_not_exist) {
+			valuesValid++;
+		} else if (value == EstiaSerial::err_data_empty) {
+			valuesEmpty++;
+		} else {
+			return;
+		}
+		if (refreshed[idx]) { refresh[idx].add(clock.millis() - lastRefresh[idx]); }
+		refreshed[idx] = true;
+		lastRefresh[idx] = clock.millis();
+	};
+
+	uint32_t endMs = static_cast<uint32_t>(hours * 3600 * 1000);
+	while (clock.millis() < endMs) {
+		uint32_t sniffStart = clock.millis();
+		EstiaSerial::SnifferState state = estiaSerial.sniffer();
+		sniffBlocking.add(clock.millis() - sniffStart);
+		switch (state) {
+		case EstiaSerial::sniff_frame_pending: {
+			SniffedFrame sniffed = estiaSerial.getSniffedFrame();
+			const FrameBuffer& frame = *sniffed;
+			framesSniffed++;
+			if (frame.size() >= FRAME_MIN_LEN
+			    && EstiaFrame::readUint16(frame, frame.size() - 2) == EstiaFrame::crc16(frame.data(), frame.size() - 2)) {
+				framesValid++;
+			}
+			if (estiaSerial.frameAck != 0) {
+				uint16_t ack = estiaSerial.getAck();
+				binaryLog.logAck(clock.millis(), ack);
+				if (ack == FRAME_DATA_TYPE_MODE_CHANGE && cmdPending) {
+					cmdLatency.add(clock.millis() - cmdQueuedAt);
+					cmdPending = false;
+				}
+			} else if (estiaSerial.newStatusData) {
+				StatusData data = estiaSerial.getStatusData();
+				binaryLog.logStatus(clock.millis(), data);
+				statusDecoded++;
+				if (data.error == StatusFrame::err_ok && data.extendedData) {
+					busSeen = true;
+					pumpRunning = data.pump1;
+				}
+				if (!scheduled && data.extendedData && data.pump1
+				    && estiaSerial.requestSensorsData(sensors, true)) {
+					cycleStart = clock.millis();
+					cycleRunning = true;
+				}
+			}
+			break;
+		}
+		case EstiaSerial::sniff_idle:
+			if (estiaSerial.newSensorsData && cycleRunning) {
+				cycleTime.add(clock.millis() - cycleStart);
+				cycleRunning = false;
+				SensorRegistry& sensorsData = estiaSerial.getSensorsData();
+				for (size_t idx = 0; idx < sensors.size(); idx++) {
+					const SensorSlot& slot = sensorsData[sensors[idx]];
+					if (slot.status == sensor_failed) { valuesFailed++; }
+					if (slot.status != sensor_unset) { sensorUpdated(idx, slot.value); }
+				}
+			}
+			// mirrors ToshibaLog::schedule_requests_()
+			if (scheduled && busSeen) {
+				if (inFlight == SCHEDULER_NONE) {
+					inFlight = scheduler.next(clock.millis(), pumpRunning ? 0 : 300000);
+					if (inFlight != SCHEDULER_NONE) { scheduler.requested(inFlight, clock.millis()); }
+				}
+				if (inFlight != SCHEDULER_NONE) {
+					uint8_t code = scheduler.sensor(inFlight).code;
+					int16_t value = estiaSerial.requestData(code);
+					if (value != EstiaSerial::err_pending) {
+						bool answered = value > EstiaSerial::err_not_exist || value == EstiaSerial::err_data_empty;
+						bool failed = estiaSerial.getSensorRegistry()[SensorRegistry::ordinal(code)].status == sensor_failed;
+						scheduler.completed(inFlight, clock.millis(), answered || failed);
+						if (failed && !answered) { valuesFailed++; }
+						sensorUpdated(inFlight, value);
+						inFlight = SCHEDULER_NONE;
+					}
+				}
+			}
+			if (clock.millis() >= nextCmd) {
+				quiet = !quiet;
+				estiaSerial.setMode("quiet", quiet);
+				cmdQueued++;
+				cmdQueuedAt = clock.millis();
+				cmdPending = true;
+				nextCmd += cmdIntervalS * 1000;
+			}
+			break;
+		default:
+			break;
+		}
+		LogRecord record;
+		while (logFile && binaryLog.pop(record)) {
+			uint8_t serialized[BINARY_LOG_HEADER_SIZE + BINARY_LOG_PAYLOAD_SIZE];
+			fwrite(serialized, 1, record.serialize(serialized, sizeof(serialized)), logFile);
+		}
+		while (capture.drain()) {}
+		clock.delay(loopMs);
+	}
+	if (logFile) { fclose(logFile); }
+	if (captureFile) { fclose(captureFile); }
+
+	printf("simulated              %.2f h (loop %u ms, seed %u)\n", hours, loopMs, config.seed);
+	printf("master frames          %u (%u damaged)\n", bus.stats.masterFrames, bus.stats.damagedFrames);
+	printf("node frames            %u (%u collisions)\n", bus.stats.nodeFrames, bus.stats.collisions);
+	printf("bytes corrupted        %u, dropped %u\n", bus.stats.corruptedBytes, bus.stats.droppedBytes);
+	printf("frames sniffed         %u (%u crc valid)\n", framesSniffed, framesValid);
+	printf("status decoded         %u\n", statusDecoded);
+	uint32_t clean = bus.stats.masterFrames - bus.stats.damagedFrames;
+	if (bus.stats.damagedFrames > 0) {
+		double recovered = framesValid > clean ? framesValid - clean : 0;
+		printf("recovery rate          %.1f %%\n", 100.0 * recovered / bus.stats.damagedFrames);
+	}
+	const FrameFixer& frameFixer = estiaSerial.getFrameFixer();
+	for (uint8_t method = 0; method < FrameFixer::fix_methods; method++) {
+		FrameFixer::FixMethod fixMethod = static_cast<FrameFixer::FixMethod>(method);
+		printf("  fixed %-15s %u\n", FrameFixer::methodName(fixMethod), frameFixer.recoveredCount(fixMethod));
+	}
+	printf("  not fixed             %u\n", frameFixer.unrecoveredCount());
+	uint32_t repairs = frameFixer.unrecoveredCount();
+	for (uint8_t method = FrameFixer::fix_missing_bytes; method < FrameFixer::fix_methods; method++) {
+		repairs += frameFixer.recoveredCount(static_cast<FrameFixer::FixMethod>(method));
+	}
+	printf("  strategy crc checks   %u (%.2f per repair)\n", frameFixer.crcCheckCount(),
+	       repairs ? static_cast<double>(frameFixer.crcCheckCount()) / repairs : 0.0);
+	printf("requests/responses     %u/%u (%u empty)\n", bus.stats.requests, bus.stats.responses, bus.stats.emptyResponses);
+	printf("sensor values          %u requested, %u valid, %u empty, %u failed\n", valuesRequested, valuesValid, valuesEmpty,
+	       valuesFailed);
+	const BusTiming& busTiming = estiaSerial.getBusTiming();
+	const char* streamNames[BUS_TIMING_STREAMS] = {nullptr, "heartbeat", "remote status", "status", "short status", "status update"};
+	for (uint8_t kind = frame_heartbeat; kind < BUS_TIMING_STREAMS; kind++) {
+		const BusStream& stream = busTiming.stream(static_cast<FrameKind>(kind));
+		printf("cadence %-14s period=%u jitter=%u ms, %s\n", streamNames[kind], stream.period, stream.jitter,
+		       busTiming.predictable(static_cast<FrameKind>(kind), clock.millis()) ? "predicted" : "not predicted");
+	}
+	const RequestTiming& requestTiming = estiaSerial.getRequestTiming();
+	const RttEstimate& busRtt = requestTiming.busEstimate();
+	printf("response time          n=%u srtt=%u rttvar=%u ms, spacing %u ms\n", busRtt.samples, busRtt.srtt(),
+	       busRtt.rttvar(), requestTiming.delay());
+	for (uint8_t ordinal : sensors) {
+		uint8_t code = SensorRegistry::code(ordinal);
+		const RttEstimate& rtt = requestTiming.codeEstimate(code);
+		printf("  %-20s n=%u srtt=%u rttvar=%u timeout=%u ms\n", SensorRegistry::name(ordinal), rtt.samples, rtt.srtt(), rtt.rttvar(),
+		       requestTiming.timeout(code));
+	}
+	printf("commands               %u queued, %u received, %u acked\n", cmdQueued, bus.stats.commands, bus.stats.acks);
+	if (!scheduled) { cycleTime.print("sensor cycle"); }
+	for (size_t idx = 0; idx < sensors.size(); idx++) {
+		char name[32];
+		snprintf(name, sizeof(name), "refresh %s (%us)", SensorRegistry::name(sensors[idx]), scheduler.sensor(idx).maxAge / 1000);
+		refresh[idx].print(name);
+	}
+	cmdLatency.print("command latency");
+	sniffBlocking.print("sniffer() blocking");
+	if (captureFile) {
+		printf("captured               %u records, %u dropped, %zu bytes\n", capture.recordCount(),
+		       capture.droppedCount(), captureSink.position());
+	}
+	return 0;
+}
@@ -0,0 +1,98 @@
+/*
+estia-sniff.cpp - replay raw Estia bus bytes through the sniffer
+Copyright (C) 2025 serek4. All rights reserved.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "estia-serial.hpp"
+#include "host-capture.hpp"
+#include "host-hal.hpp"
+#include "sim-clock.hpp"
+#include <stdio.h>
+#include <string.h>
+
+// run the sniffer until `untilUs`, printing sniffed frames; idle stretches are skipped
+static void sniffUntil(EstiaSerial& estiaSerial, BufferUart& uart, SimClock& clock, uint64_t untilUs, bool timestamps) {
+	while (true) {
+		EstiaSerial::SnifferState state = estiaSerial.sniffer();
+		if (state == EstiaSerial::sniff_frame_pending) {
+			SniffedFrame frame = estiaSerial.getSniffedFrame();
+			if (timestamps) { printf("%12.3f rx ", clock.uptimeUs() / 1000.0); }
+			printf("%s\n", EstiaFrame::stringify(*frame).c_str());
+		} else if (state == EstiaSerial::sniff_idle) {
+			if (clock.uptimeUs() >= untilUs) { return; }
+			clock.advanceTo(untilUs);
+		} else if (!uart.available()) {
+			clock.delay(1);    // waiting for the frame gap
+		}
+	}
+}
+
+/**
+* Usage: estia-sniff [raw-capture-file]
+*        estia-sniff --capture capture-file
+*
+* Feeds raw bus bytes (stdin when no file given) through `EstiaSerial::sniffer()`
+* and prints every sniffed frame as hex, one per line. Runs on `SimClock`, so
+* the per-byte and frame timeouts cost no wall time.
+*
+* `--capture` replays a `BusCapture` stream (`estia-sim --capture` or a dump
+* of the capture partition): sniffed bytes are fed at their recorded time,
+* sent frames are printed as `tx` lines, every line is prefixed with the
+* replay time in ms.
+*/
+int main(int argc, char** argv) {
+	SimClock clock;
+	BufferUart uart;
+	EstiaSerial estiaSerial(uart, clock);
+
+	if (argc > 2 && strcmp(argv[1], "--capture") == 0) {
+		std::vector<CaptureRecord> records;
+		if (!CaptureReader::load(argv[2], records)) {
+			perror(argv[2]);
+			return 1;
+		}
+		uint64_t replayUs = 0;
+		uint32_t previous = records.empty() ? 0 : records.front().timestamp;
+		for (const CaptureRecord& record : records) {
+			replayUs += record.timestamp - previous;    // micros() wraps, the difference doesn't
+			previous = record.timestamp;
+			sniffUntil(estiaSerial, uart, clock, replayUs, true);
+			if (record.tx()) {
+				printf("%12.3f tx %s\n", clock.uptimeUs() / 1000.0, EstiaFrame::stringify(FrameBuffer(record.data, record.data + record.length)).c_str());
+			} else {
+				uart.feed(record.data, record.length);
+			}
+		}
+		sniffUntil(estiaSerial, uart, clock, clock.uptimeUs(), true);
+		return 0;
+	}
+
+	FILE* input = argc > 1 ? fopen(argv[1], "rb") : stdin;
+	if (!input) {
+		perror(argv[1]);
+		return 1;
+	}
+
+	uint8_t chunk[256];
+	size_t len;
+	while ((len = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+		uart.feed(chunk, len);
+	}
+	if (input != stdin) { fclose(input); }
+
+	sniffUntil(estiaSerial, uart, clock, 0, false);
+	return 0;
+}